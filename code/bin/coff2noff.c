@@ -15,6 +15,13 @@
  *	.data	-- initialized data
  *	.bss/.sbss -- uninitialized data (should be zero'd on program startup)
  *
+ * If a page size is given, each segment is placed in the NOFF file at
+ * an offset congruent to its virtual address modulo the page size, so
+ * that every page of it is one aligned run of bytes (whole disk
+ * sectors, when the page size is a multiple of the sector size) that
+ * a loader can read with a single request.  Loaders only go by the
+ * offsets recorded in the header, so the file works either way.
+ *
  * Copyright (c) 1992-1993 The Regents of the University of California.
  * All rights reserved.  See copyright.h for copyright notice and limitation 
  * of liability and disclaimer of warranty provisions.
@@ -93,17 +100,36 @@ void Write(int fd, char *buf, int nBytes)
     }
 }
 
+/* Return the first offset from "offset" on that is congruent to
+ * "virtualAddr" modulo "pageSize" (just "offset", if "pageSize" is 0),
+ * and move the output file there; the gap reads as zeros.
+ */
+int PageAlign(int fd, int offset, int virtualAddr, int pageSize)
+{
+    if (pageSize > 0) {
+	offset += (virtualAddr - offset) & (pageSize - 1);
+	lseek(fd, offset, 0);
+    }
+    return offset;
+}
+
 int main (int argc, char **argv)
 {
-    int fdIn, fdOut, numsections, i, inNoffFile;
+    int fdIn, fdOut, numsections, i, inNoffFile, pageSize;
     struct filehdr fileh;
     struct aouthdr systemh;
     struct scnhdr *sections;
     char *buffer;
     NoffHeader noffH;
 
-    if (argc < 2) {
-	fprintf(stderr, "Usage: %s <coffFileName> <noffFileName>\n", argv[0]);
+    if (argc < 3) {
+	fprintf(stderr, "Usage: %s <coffFileName> <noffFileName> [pageSize]\n",
+		argv[0]);
+	exit(1);
+    }
+    pageSize = (argc > 3) ? atoi(argv[3]) : 0;
+    if (argc > 3 && (pageSize <= 0 || (pageSize & (pageSize - 1)) != 0)) {
+	fprintf(stderr, "Page size must be a power of two\n");
 	exit(1);
     }
     
@@ -173,6 +199,8 @@ int main (int argc, char **argv)
 		/* do nothing! */	
 	} else if (!strcmp(sections[i].s_name, ".text")) {
 	    noffH.code.virtualAddr = sections[i].s_paddr;
+	    inNoffFile = PageAlign(fdOut, inNoffFile, sections[i].s_paddr,
+	    			   pageSize);
 	    noffH.code.inFileAddr = inNoffFile;
 	    noffH.code.size = sections[i].s_size;
     	    lseek(fdIn, sections[i].s_scnptr, 0);
@@ -191,6 +219,8 @@ int main (int argc, char **argv)
 	        exit(1);
 	    }
 	    noffH.initData.virtualAddr = sections[i].s_paddr;
+	    inNoffFile = PageAlign(fdOut, inNoffFile, sections[i].s_paddr,
+	    			   pageSize);
 	    noffH.initData.inFileAddr = inNoffFile;
 	    noffH.initData.size = sections[i].s_size;
     	    lseek(fdIn, sections[i].s_scnptr, 0);
@@ -24,6 +24,43 @@
 					// execution stack, for detecting 
 					// stack overflows
 
+int stackPoolLimit = DefaultStackPoolLimit;	// most stacks kept for reuse
+static int *freeStacks = NULL;		// the stacks kept, linked through
+					// their first word
+static int numFreeStacks = 0;
+
+//----------------------------------------------------------------------
+// AllocStack, FreeStack
+// 	Get a thread execution stack, from the stacks of finished threads
+//	if there are any; and keep the stack of a finished thread for
+//	reuse, if there are fewer than stackPoolLimit kept already.
+//	Otherwise, go to AllocBoundedArray and DeallocBoundedArray.
+//----------------------------------------------------------------------
+
+static int *
+AllocStack()
+{
+    int *stack = freeStacks;
+
+    if (stack == NULL)
+	return (int *) AllocBoundedArray(StackSize * sizeof(_int));
+    freeStacks = *(int **) stack;
+    numFreeStacks--;
+    return stack;
+}
+
+static void
+FreeStack(int *stack)
+{
+    if (numFreeStacks >= stackPoolLimit) {
+	DeallocBoundedArray((char *) stack, StackSize * sizeof(_int));
+	return;
+    }
+    *(int **) stack = freeStacks;
+    freeStacks = stack;
+    numFreeStacks++;
+}
+
 //----------------------------------------------------------------------
 // Thread::Thread
 // 	Initialize a thread control block, so that we can then call
@@ -38,6 +75,8 @@ Thread::Thread(const char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    queueNext = NULL;
+    level = sliceUsed = boostEpoch = 0;
 #ifdef USER_PROGRAM
     space = NULL;
 #endif
@@ -61,7 +100,7 @@ Thread::~Thread()
 
     ASSERT(this != currentThread);
     if (stack != NULL)
-		DeallocBoundedArray((char *) stack, StackSize * sizeof(_int));
+	FreeStack(stack);
 }
 
 //----------------------------------------------------------------------
@@ -196,6 +235,7 @@ Thread::Yield ()
     
     DEBUG('t', "Yielding thread \"%s\"\n", getName());
     
+    scheduler->Charge();
     nextThread = scheduler->FindNextToRun();
     if (nextThread != NULL) {
 	scheduler->ReadyToRun(this);
@@ -234,6 +274,7 @@ Thread::Sleep ()
     DEBUG('t', "Sleeping thread \"%s\"\n", getName());
 
     status = BLOCKED;
+    scheduler->Charge();
     while ((nextThread = scheduler->FindNextToRun()) == NULL)
 	interrupt->Idle();	// no one to run, wait for an interrupt
         
@@ -267,7 +308,7 @@ void ThreadPrint(_int arg){ Thread *t = (Thread *)arg; t->Print(); }
 void
 Thread::StackAllocate (VoidFunctionPtr func, _int arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(_int));
+    stack = AllocStack();
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
@@ -405,3 +446,74 @@ Thread::RestoreUserState()
 	machine->WriteRegister(i, userRegisters[i]);
 }
 #endif
+
+//----------------------------------------------------------------------
+// ThreadQueue::Append
+//      Put a thread at the end of the queue, by linking it through its
+//	own "queueNext" field.
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::Append(Thread *thread)
+{
+    ASSERT(thread->queueNext == NULL && thread != last);
+
+    if (first == NULL)
+	first = thread;
+    else
+	last->queueNext = thread;
+    last = thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Remove
+//      Take the thread at the front of the queue off it.
+//
+// Returns:
+//	The removed thread, NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadQueue::Remove()
+{
+    Thread *thread = first;
+
+    if (thread == NULL)
+	return NULL;
+    first = thread->queueNext;
+    if (first == NULL)
+	last = NULL;
+    thread->queueNext = NULL;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Concatenate
+//      Move all the threads of another queue, in order, to the end of
+//	this one, leaving the other queue empty.  O(1).
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::Concatenate(ThreadQueue *other)
+{
+    if (other->first == NULL)
+	return;
+    if (first == NULL)
+	first = other->first;
+    else
+	last->queueNext = other->first;
+    last = other->last;
+    other->first = other->last = NULL;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Mapcar
+//	Apply a function to each thread on the queue, front to back.
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::Mapcar(VoidFunctionPtr func)
+{
+    for (Thread *t = first; t != NULL; t = t->queueNext)
+	(*func)((_int) t);
+}
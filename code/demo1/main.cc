@@ -8,9 +8,11 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
+// Usage: nachos -d <debugflags> -rs <random seed #> -mlfq -sp <stacks>
 //		-s -x <nachos file> -c <consoleIn> <consoleOut>
-//		-f -cp <unix file> <nachos file>
+//		-f -ds <policy> -dc <sectors> -ra <sectors> -db <backend>
+//		-dg <tracks> <sectors> -dt <seek> <rotation> -dl <model>
+//		-cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
 //              -o <other machine id>
@@ -18,6 +20,8 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -mlfq schedules threads with a multilevel feedback queue
+//    -sp sets how many stacks of finished threads are kept for reuse
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
@@ -27,6 +31,14 @@
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
+//    -ds sets the disk scheduling policy: fcfs, sstf, scan or clook
+//    -dc sets how many sectors the disk cache holds (0 for none)
+//    -ra sets how many sectors sequential file reads prefetch (0 for none)
+//    -db sets how the disk's UNIX file is accessed: file, mmap or msync
+//    -dg sets how many tracks the disk has, and sectors per track
+//    -dt sets how many ticks the disk takes to seek one track, and to
+//	rotate past one sector
+//    -dl sets how disk latency is modelled: track, ssd or zoned
 //    -cp copies a file from UNIX to Nachos
 //    -p prints a Nachos file to stdout
 //    -r removes a Nachos file from the file system
@@ -29,6 +29,7 @@ OpenFile::OpenFile(int sector) {
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
     seekPosition = 0;
+    lastRead = readAhead = -1;
 }
 
 //----------------------------------------------------------------------
@@ -85,7 +86,9 @@ int OpenFile::Write(char *into, int numBytes) {
 //
 //	For ReadAt:
 //	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   request, but we only copy the part we are interested in.  If the
+//	   request starts where the last one left off, the file is being
+//	   read sequentially, and we read ahead.
 //	For WriteAt:
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
@@ -102,6 +105,7 @@ int OpenFile::Write(char *into, int numBytes) {
 int OpenFile::ReadAt(char *into, int numBytes, int position) {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
+    int *sectors;
     char *buf;
 
     if ((numBytes <= 0) || (position >= fileLength)) return 0;  // check request
@@ -113,15 +117,29 @@ int OpenFile::ReadAt(char *into, int numBytes, int position) {
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
+    // read in all the full and partial sectors that we need, straight
+    // into the caller's buffer if the request is whole sectors
+    if (position % SectorSize == 0 && numBytes % SectorSize == 0)
+        buf = into;
+    else
+        buf = new char[numSectors * SectorSize];
+    sectors = new int[numSectors];
     for (i = firstSector; i <= lastSector; i++)
-        synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize),
-                              &buf[(i - firstSector) * SectorSize]);
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    synchDisk->ReadSectors(numSectors, sectors, buf);
+    delete[] sectors;
 
     // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete[] buf;
+    if (buf != into) {
+        bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
+        delete[] buf;
+    }
+
+    if (firstSector == lastRead || firstSector == lastRead + 1)
+        ReadAhead(lastSector);
+    else
+        readAhead = -1;
+    lastRead = lastSector;
     return numBytes;
 }
 
@@ -129,6 +147,7 @@ int OpenFile::WriteAt(char *from, int numBytes, int position) {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
     bool firstAligned, lastAligned;
+    int *sectors;
     char *buf;
 
     if ((numBytes <= 0) ||
@@ -143,29 +162,55 @@ int OpenFile::WriteAt(char *from, int numBytes, int position) {
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    buf = new char[numSectors * SectorSize];
-
     firstAligned = (bool)(position == (firstSector * SectorSize));
     lastAligned =
         (bool)((position + numBytes) == ((lastSector + 1) * SectorSize));
 
+    sectors = new int[numSectors];
+    for (i = firstSector; i <= lastSector; i++)
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    if (firstAligned && lastAligned) {  // whole sectors: write them as is
+        synchDisk->WriteSectors(numSectors, sectors, from);
+        delete[] sectors;
+        return numBytes;
+    }
+    buf = new char[numSectors * SectorSize];
+
     // read in first and last sector, if they are to be partially modified
-    if (!firstAligned) ReadAt(buf, SectorSize, firstSector * SectorSize);
+    if (!firstAligned) synchDisk->ReadSector(sectors[0], buf);
     if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], SectorSize,
-               lastSector * SectorSize);
+        synchDisk->ReadSector(sectors[numSectors - 1],
+                              &buf[(lastSector - firstSector) * SectorSize]);
 
     // copy in the bytes we want to change
     bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
     // write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)
-        synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize),
-                               &buf[(i - firstSector) * SectorSize]);
+    synchDisk->WriteSectors(numSectors, sectors, buf);
+    delete[] sectors;
     delete[] buf;
     return numBytes;
 }
 
+//----------------------------------------------------------------------
+// OpenFile::ReadAhead
+// 	Start reading the "readAheadWindow" sectors of the file after
+//	"sector" into the disk cache, so that the next sequential read
+//	finds them there.  Sectors already read ahead are skipped.
+//	Following right behind a read, these mostly come out of the
+//	disk's track buffer.
+//----------------------------------------------------------------------
+
+void OpenFile::ReadAhead(int sector) {
+    int last = divRoundUp(hdr->FileLength(), SectorSize) - 1;
+    int i;
+
+    if (sector + readAheadWindow < last) last = sector + readAheadWindow;
+    for (i = max(sector, readAhead) + 1; i <= last; i++)
+        synchDisk->Prefetch(hdr->ByteToSector(i * SectorSize));
+    if (last > readAhead) readAhead = last;
+}
+
 //----------------------------------------------------------------------
 // OpenFile::Length
 // 	Return the number of bytes in the file.
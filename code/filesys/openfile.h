@@ -95,6 +95,11 @@ class OpenFile {
    private:
     FileHeader *hdr;   // Header for this file
     int seekPosition;  // Current position within the file
+    int lastRead;      // Last sector of the file read, or -1
+    int readAhead;     // Sectors up to this one have been read ahead
+
+    void ReadAhead(int sector);  // Prefetch the sectors following
+                                 // "sector", after a sequential read
 };
 
 #endif  // FILESYS
@@ -5,10 +5,31 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	Each request waits on its own semaphore, which the interrupt
+//	handler signals when the request completes.  Because the
+//	physical disk can only handle one operation at a time, requests
+//	that come in while it is busy are queued; when the disk finishes
+//	one, the interrupt handler picks the next according to the disk
+//	scheduling policy, and starts it.  The queue is shared with the
+//	interrupt handler, so it is protected by disabling interrupts.
+//
+//	On top of that sits a buffer cache of recently used sectors,
+//	replaced in least recently used order.  Writes only change the
+//	cached copy; a changed ("dirty") sector is written to disk when its
+//	entry is reused, when Flush is called, or when Nachos halts.  While
+//	an entry is being read or written, it is marked busy, and other
+//	threads wanting it wait until it is done.
+//
+//	A request may cover a run of consecutive sectors, which the disk
+//	transfers with a single interrupt.  ReadSectors/WriteSectors take a
+//	list of sectors, and read the runs of it that are not cached as
+//	single requests; dirty sectors next to each other on disk are
+//	written back together.
+//
+//	Read-ahead (Prefetch) puts a request on the disk queue for a
+//	sector, and returns without waiting for it.  The request carries
+//	its own semaphore, which the first thread to want the sector waits
+//	on -- holding the cache lock, so nobody else can get in the way.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -17,6 +38,12 @@
 #include "synchdisk.h"
 
 #include "copyright.h"
+#include "system.h"
+
+DiskPolicy diskPolicy = FCFS;
+const char* diskPolicyNames[] = {"fcfs", "sstf", "scan", "clook"};
+int diskCacheSize = DefaultCacheSectors;
+int readAheadWindow = DefaultReadAhead;
 
 //----------------------------------------------------------------------
 // DiskRequestDone
@@ -30,6 +57,22 @@ static void DiskRequestDone(_int arg) {
     dsk->RequestDone();  // disk -> dsk
 }
 
+//----------------------------------------------------------------------
+// DiskRequest::DiskRequest
+// 	Initialize a request to read/write "count" sectors, starting at
+//	"sector", from/to "buffer".  The requesting thread sets up "done".
+//----------------------------------------------------------------------
+
+DiskRequest::DiskRequest(int sector, int count, char* buffer, bool isWrite) {
+    sectorNumber = sector;
+    numSectors = count;
+    data = buffer;
+    writing = isWrite;
+    done = NULL;
+    finished = FALSE;
+    next = NULL;
+}
+
 //----------------------------------------------------------------------
 // SynchDisk::SynchDisk
 // 	Initialize the synchronous interface to the physical disk, in turn
@@ -40,21 +83,90 @@ static void DiskRequestDone(_int arg) {
 //----------------------------------------------------------------------
 
 SynchDisk::SynchDisk(const char* name) {
-    semaphore = new Semaphore("synch disk", 0);
-    lock = new Lock("synch disk lock");
+    policy = diskPolicy;
+    stats->seekPolicy = diskPolicyNames[policy];
+    queue = active = NULL;
+    headSector = 0;
+    movingUp = TRUE;
     disk = new Disk(name, DiskRequestDone, (_int)this);
+
+    cacheSize = diskCacheSize;
+    cache = NULL;
+    buckets = NULL;
+    lruFirst = lruLast = NULL;
+    if (cacheSize > 0) {
+        cache = new CacheEntry[cacheSize];
+        buckets = new CacheEntry*[cacheSize];
+        for (int i = 0; i < cacheSize; i++) {
+            cache[i].sector = -1;
+            cache[i].dirty = cache[i].busy = cache[i].prefetched = FALSE;
+            cache[i].pending = NULL;
+            cache[i].prev = (i > 0) ? &cache[i - 1] : NULL;
+            cache[i].next = (i < cacheSize - 1) ? &cache[i + 1] : NULL;
+            cache[i].hashNext = NULL;
+            buckets[i] = NULL;
+        }
+        lruFirst = &cache[0];
+        lruLast = &cache[cacheSize - 1];
+    }
+    cacheLock = new Lock("synch disk cache lock");
+    cacheIO = new Condition("synch disk cache I/O");
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::~SynchDisk
 // 	De-allocate data structures needed for the synchronous disk
-//	abstraction.
+//	abstraction, first writing any dirty sectors back to disk.
+//
+//	This is called as Nachos halts, when there may be no thread left
+//	to wait for the disk; so rather than sleeping, we idle the machine
+//	until each disk interrupt comes in.  Requests still in progress
+//	are let finish first.
 //----------------------------------------------------------------------
 
 SynchDisk::~SynchDisk() {
+    Semaphore flushed("synch disk flush", 0);
+    DiskRequest** writes = new DiskRequest*[cacheSize + 1];
+    CacheEntry** run = new CacheEntry*[cacheSize + 1];
+    int numWrites = 0;
+
+    (void)interrupt->SetLevel(IntOff);
+    while (active != NULL) interrupt->Idle();
+    for (int i = 0; i < cacheSize; i++)
+        if (cache[i].dirty && !cache[i].busy) {
+            int n = GatherRun(&cache[i], run);
+            char* data = new char[n * SectorSize];
+            DiskRequest* request;
+
+            for (int k = 0; k < n; k++) {
+                bcopy(run[k]->data, &data[k * SectorSize], SectorSize);
+                run[k]->busy = TRUE;
+            }
+            request = new DiskRequest(run[0]->sector, n, data, TRUE);
+            request->done = &flushed;
+            request->next = queue;
+            queue = request;
+            writes[numWrites++] = request;
+        }
+    StartNext();
+    while (active != NULL) interrupt->Idle();
+    for (int i = 0; i < numWrites; i++) {
+        delete[] writes[i]->data;
+        delete writes[i];
+    }
+    delete[] writes;
+    delete[] run;
+    for (int i = 0; i < cacheSize; i++)
+        if (cache[i].pending != NULL) {
+            delete cache[i].pending->done;
+            delete cache[i].pending;
+        }
+
+    delete cacheIO;
+    delete cacheLock;
+    delete[] buckets;
+    delete[] cache;
     delete disk;
-    delete lock;
-    delete semaphore;
 }
 
 //----------------------------------------------------------------------
@@ -67,10 +179,7 @@ SynchDisk::~SynchDisk() {
 //----------------------------------------------------------------------
 
 void SynchDisk::ReadSector(int sectorNumber, char* data) {
-    lock->Acquire();  // only one disk I/O at a time
-    disk->ReadRequest(sectorNumber, data);
-    semaphore->P();  // wait for interrupt
-    lock->Release();
+    ReadSectors(1, &sectorNumber, data);
 }
 
 //----------------------------------------------------------------------
@@ -83,16 +192,518 @@ void SynchDisk::ReadSector(int sectorNumber, char* data) {
 //----------------------------------------------------------------------
 
 void SynchDisk::WriteSector(int sectorNumber, char* data) {
-    lock->Acquire();  // only one disk I/O at a time
-    disk->WriteRequest(sectorNumber, data);
-    semaphore->P();  // wait for interrupt
-    lock->Release();
+    WriteSectors(1, &sectorNumber, data);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors
+// 	Read "numSectors" disk sectors, sectors[i] into
+//	data[i * SectorSize], returning only after they have all been
+//	read.  Cached sectors are copied out of the cache.  Runs of
+//	consecutive sectors that are not cached go to the disk as one
+//	request each, and are then cached, if there are entries free for
+//	them without waiting; their entries are busy until the data is in.
+//
+//	"numSectors" -- how many sectors to read
+//	"sectors" -- the disk sectors to read
+//	"data" -- the buffer to hold their contents
+//----------------------------------------------------------------------
+
+void SynchDisk::ReadSectors(int numSectors, int* sectors, char* data) {
+    CacheEntry** run;
+    CacheEntry* entry;
+    int i, k, n;
+
+    if (cacheSize == 0) {
+        for (i = 0; i < numSectors; i += n) {
+            for (n = 1; i + n < numSectors && sectors[i + n] == sectors[i] + n;
+                 n++)
+                ;
+            Transfer(sectors[i], n, &data[i * SectorSize], FALSE);
+        }
+        return;
+    }
+
+    run = new CacheEntry*[numSectors];
+    cacheLock->Acquire();
+    for (i = 0; i < numSectors; i += n) {
+        for (n = 0; i + n < numSectors; n++) {
+            if (n > 0 && sectors[i + n] != sectors[i] + n) break;
+            if (Lookup(sectors[i + n]) != NULL) break;
+            if ((run[n] = Claim(sectors[i + n])) == NULL) break;
+            run[n]->busy = TRUE;
+        }
+
+        if (n == 0) {  // cached, or no entry to be had without waiting
+            n = 1;
+            entry = GetEntry(sectors[i], TRUE);
+            bcopy(entry->data, &data[i * SectorSize], SectorSize);
+            continue;
+        }
+        stats->numCacheMisses += n;
+        cacheLock->Release();
+        Transfer(sectors[i], n, &data[i * SectorSize], FALSE);
+        cacheLock->Acquire();
+        for (k = 0; k < n; k++) {
+            bcopy(&data[(i + k) * SectorSize], run[k]->data, SectorSize);
+            run[k]->busy = FALSE;
+        }
+        cacheIO->Broadcast(cacheLock);
+    }
+    cacheLock->Release();
+    delete[] run;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteSectors
+// 	Write "numSectors" disk sectors, sectors[i] from data[i * SectorSize].
+//	With the cache, this only changes the cached copies; without it,
+//	runs of consecutive sectors go to the disk as one request each.
+//
+//	"numSectors" -- how many sectors to write
+//	"sectors" -- the disk sectors to write
+//	"data" -- their new contents
+//----------------------------------------------------------------------
+
+void SynchDisk::WriteSectors(int numSectors, int* sectors, char* data) {
+    CacheEntry* entry;
+    int i, n;
+
+    if (cacheSize == 0) {
+        for (i = 0; i < numSectors; i += n) {
+            for (n = 1; i + n < numSectors && sectors[i + n] == sectors[i] + n;
+                 n++)
+                ;
+            Transfer(sectors[i], n, &data[i * SectorSize], TRUE);
+        }
+        return;
+    }
+
+    cacheLock->Acquire();
+    for (i = 0; i < numSectors; i++) {
+        entry = GetEntry(sectors[i], FALSE);
+        bcopy(&data[i * SectorSize], entry->data, SectorSize);
+        entry->dirty = TRUE;
+        entry->prefetched = FALSE;  // what was read ahead is gone
+    }
+    cacheLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Flush
+// 	Write every dirty cached sector back to disk, returning once they
+//	have all been written.  The sectors stay cached.  This is also a
+//	barrier for the disk itself (cf. Disk::Sync).
+//----------------------------------------------------------------------
+
+void SynchDisk::Flush() {
+    cacheLock->Acquire();
+    for (int i = 0; i < cacheSize; i++) {
+        if (cache[i].pending != NULL) FinishReadAhead(&cache[i]);
+        while (cache[i].busy) cacheIO->Wait(cacheLock);
+        if (cache[i].dirty) WriteBack(&cache[i]);
+    }
+    cacheLock->Release();
+    disk->Sync();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Prefetch
+// 	Start reading "sectorNumber" into the cache, and return without
+//	waiting for it.  Nothing is done if the sector is already cached,
+//	if getting an entry for it would mean waiting for the disk, or if
+//	it would push out another sector read ahead and not yet used.
+//----------------------------------------------------------------------
+
+void SynchDisk::Prefetch(int sectorNumber) {
+    CacheEntry* entry;
+    DiskRequest* request;
+
+    if (cacheSize == 0) return;
+    cacheLock->Acquire();
+    if (Lookup(sectorNumber) == NULL) {
+        entry = Claim(sectorNumber);
+        if (entry != NULL) {
+            request = new DiskRequest(sectorNumber, 1, entry->data, FALSE);
+            request->done = new Semaphore("read-ahead", 0);
+            entry->busy = entry->prefetched = TRUE;
+            entry->pending = request;
+            stats->numReadAheads++;
+            Start(request);
+        }
+    }
+    cacheLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Transfer
+// 	Read/write "numSectors" consecutive sectors on the disk itself,
+//	bypassing the cache.  Return only after the transfer is done.
+//----------------------------------------------------------------------
+
+void SynchDisk::Transfer(int sectorNumber, int numSectors, char* data,
+                         bool writing) {
+    DiskRequest request(sectorNumber, numSectors, data, writing);
+
+    Queue(&request);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Queue
+// 	Put a request on the queue, start it right away if the disk is
+//	idle, and wait for the disk interrupt that says it is done.
+//----------------------------------------------------------------------
+
+void SynchDisk::Queue(DiskRequest* request) {
+    Semaphore done("synch disk request", 0);
+
+    request->done = &done;
+    Start(request);
+    done.P();  // wait for interrupt
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Start
+// 	Put a request on the queue, and start it right away if the disk
+//	is idle.
+//----------------------------------------------------------------------
+
+void SynchDisk::Start(DiskRequest* request) {
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    request->next = queue;  // order on the queue does not matter,
+    queue = request;        // except to FCFS, which takes the last
+    if (active == NULL) StartNext();
+    (void)interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::RequestDone
-// 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+// 	Disk interrupt handler.  Wake up the thread waiting for the
+//	request that just completed, and start the next one.
+//----------------------------------------------------------------------
+
+void SynchDisk::RequestDone() {
+    DiskRequest* request = active;
+
+    active = NULL;
+    request->finished = TRUE;
+    request->done->V();
+    StartNext();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::StartNext
+// 	If any requests are queued, send the one "policy" picks to the
+//	disk.  Called with interrupts disabled.
+//----------------------------------------------------------------------
+
+void SynchDisk::StartNext() {
+    DiskRequest* request;
+
+    if (queue == NULL) return;
+    request = PickNext();
+    active = request;
+
+    headSector = request->sectorNumber + request->numSectors - 1;
+    if (request->writing)
+        disk->WriteRun(request->sectorNumber, request->numSectors,
+                       request->data);
+    else
+        disk->ReadRun(request->sectorNumber, request->numSectors,
+                      request->data);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::PickNext
+// 	Take the request to serve next off the queue, and return it.
+//	The queue is kept newest first, so FCFS takes the last one; the
+//	other policies look at where the requests are relative to the
+//	disk head.  Ties go to the older request.
+//----------------------------------------------------------------------
+
+DiskRequest* SynchDisk::PickNext() {
+    DiskRequest *best = NULL, *bestPrev = NULL;
+    DiskRequest *r, *prev;
+    int head = headSector;
+
+    for (prev = NULL, r = queue; r != NULL; prev = r, r = r->next) {
+        int s = r->sectorNumber;
+        bool better;
+
+        if (best == NULL) {
+            better = TRUE;
+        } else {
+            int b = best->sectorNumber;
+
+            switch (policy) {
+                case SSTF:
+                    better = abs(s - head) <= abs(b - head);
+                    break;
+                case SCAN: {  // nearest ahead of the head, if any
+                    int ahead = movingUp ? s - head : head - s;
+                    int bestAhead = movingUp ? b - head : head - b;
+
+                    if ((ahead >= 0) != (bestAhead >= 0))
+                        better = (ahead >= 0);
+                    else
+                        better = abs(ahead) <= abs(bestAhead);
+                    break;
+                }
+                case CLOOK:  // nearest at or above the head, if any;
+                             // else the lowest
+                    if ((s >= head) != (b >= head))
+                        better = (s >= head);
+                    else
+                        better = (s <= b);
+                    break;
+                default:  // FCFS
+                    better = TRUE;
+                    break;
+            }
+        }
+        if (better) {
+            best = r;
+            bestPrev = prev;
+        }
+    }
+
+    if (policy == SCAN && best->sectorNumber != headSector)
+        movingUp = (best->sectorNumber > headSector);
+    if (bestPrev == NULL)
+        queue = best->next;
+    else
+        bestPrev->next = best->next;
+    return best;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Lookup
+// 	Return the cache entry holding "sectorNumber", or NULL if it is
+//	not cached.  Called with the cache lock held.
+//----------------------------------------------------------------------
+
+CacheEntry* SynchDisk::Lookup(int sectorNumber) {
+    CacheEntry* entry = buckets[sectorNumber % cacheSize];
+
+    while (entry != NULL && entry->sector != sectorNumber)
+        entry = entry->hashNext;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::GetEntry
+// 	Return the cache entry for "sectorNumber", making it the most
+//	recently used.  If the sector is not cached, reuse the least
+//	recently used entry that is not busy, writing it back first if it
+//	is dirty.  If "load", the entry must hold the sector's contents,
+//	so read them in from disk; otherwise the caller is about to
+//	overwrite the whole sector.
+//
+//	Called with the cache lock held; the lock is released while we
+//	wait for the disk, so anything may have changed by the time we
+//	have it back, and we start over.
+//----------------------------------------------------------------------
+
+CacheEntry* SynchDisk::GetEntry(int sectorNumber, bool load) {
+    CacheEntry* entry;
+
+    for (;;) {
+        entry = Lookup(sectorNumber);
+        if (entry != NULL) {
+            if (entry->pending != NULL) FinishReadAhead(entry);
+            if (entry->busy) {
+                cacheIO->Wait(cacheLock);
+                continue;
+            }
+            if (load) {
+                stats->numCacheHits++;
+                if (entry->prefetched) stats->numReadAheadHits++;
+                entry->prefetched = FALSE;
+            }
+            break;
+        }
+
+        entry = FindVictim();
+        if (entry == NULL) {  // everything is busy
+            WaitForEntry();
+            continue;
+        }
+        if (entry->dirty) {
+            WriteBack(entry);
+            continue;
+        }
+
+        Rehash(entry, sectorNumber);
+        if (load) {
+            stats->numCacheMisses++;
+            entry->busy = TRUE;
+            cacheLock->Release();
+            Transfer(sectorNumber, 1, entry->data, FALSE);
+            cacheLock->Acquire();
+            entry->busy = FALSE;
+            cacheIO->Broadcast(cacheLock);
+        }
+        break;
+    }
+    Touch(entry);
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::FindVictim
+// 	Return the least recently used cache entry that is not busy, or
+//	NULL if they all are.  Entries whose read-ahead has completed are
+//	no longer busy.
 //----------------------------------------------------------------------
 
-void SynchDisk::RequestDone() { semaphore->V(); }
+CacheEntry* SynchDisk::FindVictim() {
+    CacheEntry* entry;
+
+    for (entry = lruLast; entry != NULL; entry = entry->prev) {
+        if (entry->pending != NULL && entry->pending->finished)
+            FinishReadAhead(entry);
+        if (!entry->busy) break;
+    }
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Claim
+// 	Take over the least recently used cache entry for "sectorNumber",
+//	which is not cached, if that can be done without waiting: the
+//	entry must be idle, clean, and not holding a sector read ahead
+//	and not yet used.  Return NULL if there is no such entry.
+//----------------------------------------------------------------------
+
+CacheEntry* SynchDisk::Claim(int sectorNumber) {
+    CacheEntry* entry = FindVictim();
+
+    if (entry == NULL || entry->dirty || entry->prefetched) return NULL;
+    Rehash(entry, sectorNumber);
+    Touch(entry);
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WaitForEntry
+// 	Every cache entry is busy: wait until one is not.  Read-aheads
+//	have no thread to signal when they are done, so if one is in
+//	progress, wait for it directly.
+//----------------------------------------------------------------------
+
+void SynchDisk::WaitForEntry() {
+    for (CacheEntry* entry = lruLast; entry != NULL; entry = entry->prev)
+        if (entry->pending != NULL) {
+            FinishReadAhead(entry);
+            return;
+        }
+    cacheIO->Wait(cacheLock);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteBack
+// 	Write a dirty cache entry to disk, together with the dirty entries
+//	for the sectors either side of it, as one request.  The entries
+//	are busy while they are written, so nobody changes them under us.
+//	Called with the cache lock held.
+//----------------------------------------------------------------------
+
+void SynchDisk::WriteBack(CacheEntry* entry) {
+    CacheEntry** run = new CacheEntry*[cacheSize];
+    int n = GatherRun(entry, run);
+    char* data = (n == 1) ? entry->data : new char[n * SectorSize];
+    int k;
+
+    for (k = 0; k < n; k++) {
+        if (n > 1) bcopy(run[k]->data, &data[k * SectorSize], SectorSize);
+        run[k]->busy = TRUE;
+    }
+    cacheLock->Release();
+    Transfer(run[0]->sector, n, data, TRUE);
+    cacheLock->Acquire();
+    for (k = 0; k < n; k++) {
+        run[k]->dirty = FALSE;
+        run[k]->busy = FALSE;
+    }
+    cacheIO->Broadcast(cacheLock);
+    if (n > 1) delete[] data;
+    delete[] run;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::GatherRun
+// 	Put the dirty, idle cache entries for the run of consecutive
+//	sectors around "entry"'s (which must be dirty and idle itself)
+//	into "run", in sector order, and return how many there are.
+//----------------------------------------------------------------------
+
+int SynchDisk::GatherRun(CacheEntry* entry, CacheEntry** run) {
+    CacheEntry* e;
+    int first = entry->sector, n = 0;
+
+    while (first > 0 && (e = Lookup(first - 1)) != NULL && e->dirty &&
+           !e->busy)
+        first--;
+    while (first + n < NumSectors && (e = Lookup(first + n)) != NULL &&
+           e->dirty && !e->busy)
+        run[n++] = e;
+    return n;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::FinishReadAhead
+// 	Wait for the read-ahead filling a cache entry to complete, and
+//	retire its request.  We keep the cache lock while we wait: anyone
+//	else wanting the cache waits for the same disk read anyway.
+//----------------------------------------------------------------------
+
+void SynchDisk::FinishReadAhead(CacheEntry* entry) {
+    DiskRequest* request = entry->pending;
+
+    request->done->P();
+    delete request->done;
+    delete request;
+    entry->pending = NULL;
+    entry->busy = FALSE;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Rehash
+// 	Move a clean, idle cache entry to the hash bucket for
+//	"sectorNumber", forgetting whatever it held before.
+//----------------------------------------------------------------------
+
+void SynchDisk::Rehash(CacheEntry* entry, int sectorNumber) {
+    if (entry->sector >= 0) {
+        CacheEntry** link = &buckets[entry->sector % cacheSize];
+
+        while (*link != entry) link = &(*link)->hashNext;
+        *link = entry->hashNext;
+    }
+    if (entry->prefetched) stats->numReadAheadWasted++;
+    entry->prefetched = FALSE;
+    entry->sector = sectorNumber;
+    entry->hashNext = buckets[sectorNumber % cacheSize];
+    buckets[sectorNumber % cacheSize] = entry;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Touch
+// 	Move a cache entry to the front of the LRU list.
+//----------------------------------------------------------------------
+
+void SynchDisk::Touch(CacheEntry* entry) {
+    if (entry == lruFirst) return;
+
+    entry->prev->next = entry->next;  // unlink; entry is not first
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    else
+        lruLast = entry->prev;
+
+    entry->prev = NULL;
+    entry->next = lruFirst;
+    lruFirst->prev = entry;
+    lruFirst = entry;
+}
@@ -14,6 +14,57 @@
 #include "disk.h"
 #include "synch.h"
 
+// Order in which SynchDisk hands queued requests to the disk:
+//	FCFS -- first come, first served
+//	SSTF -- shortest seek time first: the request nearest the head
+//	SCAN -- elevator: keep moving the head the same way while there
+//		are requests ahead of it, then turn around
+//	CLOOK -- circular LOOK: serve requests in increasing sector order,
+//		then jump back to the lowest one
+enum DiskPolicy { FCFS, SSTF, SCAN, CLOOK };
+
+extern DiskPolicy diskPolicy;  // policy for new SynchDisks (-ds)
+extern const char* diskPolicyNames[];
+
+#define DefaultCacheSectors 64  // sectors SynchDisk keeps in memory
+#define DefaultReadAhead 4       // sectors read ahead of sequential reads
+
+extern int diskCacheSize;    // cache size for new SynchDisks (-dc)
+extern int readAheadWindow;  // sectors OpenFile reads ahead (-ra)
+
+// A read or write of one or more consecutive sectors waiting for the
+// disk, queued by the requesting thread,
+// which waits on "done" until the disk interrupt for it comes in.
+// Read-ahead requests have nobody waiting for them; whoever wants the
+// sector first waits on "done".
+class DiskRequest {
+   public:
+    DiskRequest(int sector, int count, char* buffer, bool isWrite);
+
+    int sectorNumber;  // the first disk sector to read/write
+    int numSectors;    // how many sectors, from sectorNumber on
+    char* data;        // the bytes to be written or read into
+    bool writing;      // a write, rather than a read?
+    Semaphore* done;   // V'ed when the request completes
+    bool finished;     // has the request completed?
+    DiskRequest* next;  // next request on the queue
+};
+
+// A sector held in SynchDisk's buffer cache.  Entries are kept on a list
+// in least recently used order, and hashed by sector number.
+class CacheEntry {
+   public:
+    int sector;              // the sector held here, or -1 if none
+    bool dirty;              // changed since it was last written to disk?
+    bool busy;               // being read from or written to the disk?
+    bool prefetched;         // read ahead, and not read by anyone yet?
+    DiskRequest* pending;    // the read-ahead filling this entry, if any
+    char data[SectorSize];   // the contents of the sector
+    CacheEntry* prev;        // LRU list, most recently used first
+    CacheEntry* next;
+    CacheEntry* hashNext;    // next entry in the same hash bucket
+};
+
 // The following class defines a "synchronous" disk abstraction.
 // As with other I/O devices, the raw physical disk is an asynchronous device --
 // requests to read or write portions of the disk return immediately,
@@ -23,7 +74,13 @@
 //
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
-// returning.
+// returning.  Requests from several threads are queued, and handed to
+// the disk one at a time, in the order chosen by "diskPolicy".
+//
+// Recently used sectors are kept in a write-back cache: reads of a cached
+// sector do not go to the disk at all, and writes only change the cached
+// copy, which goes to disk when it is evicted, or when Flush is called.
+// Prefetch starts reading a sector into the cache without waiting for it.
 class SynchDisk {
    public:
     SynchDisk(const char* name);  // Initialize a synchronous disk,
@@ -33,21 +90,68 @@ class SynchDisk {
     void ReadSector(int sectorNumber, char* data);
     // Read/write a disk sector, returning
     // only once the data is actually read
-    // or written.  These call
-    // Disk::ReadRequest/WriteRequest and
-    // then wait until the request is done.
+    // or written.  These queue a request,
+    // and wait until the disk has done it.
     void WriteSector(int sectorNumber, char* data);
 
+    void ReadSectors(int numSectors, int* sectors, char* data);
+    // Read/write sectors[i] from/to
+    // data[i * SectorSize], with runs of
+    // consecutive sectors as one request
+    void WriteSectors(int numSectors, int* sectors, char* data);
+
+    void Prefetch(int sectorNumber);  // Start reading a sector into
+                                      // the cache, without waiting
+    void Flush();  // Write all changed cached sectors to disk
+
     void RequestDone();  // Called by the disk device interrupt
                          // handler, to signal that the
                          // current disk operation is complete.
 
    private:
-    Disk* disk;            // Raw disk device
-    Semaphore* semaphore;  // To synchronize requesting thread
-                           // with the interrupt handler
-    Lock* lock;            // Only one read/write request
-                           // can be sent to the disk at a time
+    Disk* disk;               // Raw disk device
+    DiskPolicy policy;        // order to serve queued requests in
+    DiskRequest* queue;       // requests not yet sent to the disk
+    DiskRequest* active;      // the request the disk is doing, if any
+    int headSector;           // the last sector sent to the disk
+    bool movingUp;            // for SCAN: head moving to higher sectors?
+
+    int cacheSize;            // number of cache entries; 0 for no cache
+    CacheEntry* cache;        // the cache entries
+    CacheEntry** buckets;     // hash table of entries, by sector
+    CacheEntry* lruFirst;     // most recently used entry
+    CacheEntry* lruLast;      // least recently used entry
+    Lock* cacheLock;          // only one thread at a time in the cache
+    Condition* cacheIO;       // signalled when a busy entry is done
+
+    void Transfer(int sectorNumber, int numSectors, char* data,
+                  bool writing);
+    // Read/write consecutive sectors on
+    // the disk itself, bypassing the cache
+    void Queue(DiskRequest* request);  // Queue a request, and wait
+                                       // until it is done
+    void Start(DiskRequest* request);  // Queue a request, starting it
+                                       // if the disk is idle
+    void StartNext();  // Send the next queued request to the disk
+    DiskRequest* PickNext();  // Take the next request to serve off
+                              // the queue, according to "policy"
+
+    CacheEntry* Lookup(int sectorNumber);  // Find a sector in the cache
+    CacheEntry* GetEntry(int sectorNumber, bool load);
+    // Find or make the cache entry for a
+    // sector, reading it in if "load"
+    CacheEntry* FindVictim();  // Find an entry to reuse
+    CacheEntry* Claim(int sectorNumber);  // Reuse an entry for a sector,
+                                          // if that needs no waiting
+    void WaitForEntry();       // Wait until some entry is not busy
+    void WriteBack(CacheEntry* entry);  // Write a dirty entry to disk
+    int GatherRun(CacheEntry* entry, CacheEntry** run);
+    // Find the dirty entries next to it
+    void FinishReadAhead(CacheEntry* entry);  // Wait for an entry's
+                                              // read-ahead to complete
+    void Rehash(CacheEntry* entry, int sectorNumber);
+    // Reuse an entry for another sector
+    void Touch(CacheEntry* entry);  // Make an entry most recently used
 };
 
 #endif  // SYNCHDISK_H
@@ -11,8 +11,14 @@
 //	end up calling FindNextToRun(), and that would put us in an
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	Priority scheduling: one FIFO queue per priority level, with a
+//	bitmap of the non-empty levels.
+//
+//	Aging does not walk the ready threads.  The queues form a ring,
+//	and "zeroLevel" says which of them currently holds priority 0.
+//	Moving zeroLevel on by one ages every ready thread at once;
+//	only the threads already at priority 0 have to be moved, by
+//	splicing their queue onto the new priority 0 queue.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -28,29 +34,84 @@
 // 	Initialize the list of ready but not running threads to empty.
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler() { readyList = new List; }
+Scheduler::Scheduler() {
+    readyList = new ThreadQueue[NumPriorities];
+    for (int i = 0; i < MaskWords; i++) readyMask[i] = 0;
+    zeroLevel = 0;
+#ifdef THREAD_AGING
+    agingTicks = 0;
+#endif
+}
 
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
 // 	De-allocate the list of ready threads.
 //----------------------------------------------------------------------
 
-Scheduler::~Scheduler() { delete readyList; }
+Scheduler::~Scheduler() { delete[] readyList; }
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 // 	Mark a thread as ready, but not running.
-//	Put it on the ready list, for later scheduling onto the CPU.
+//	Put it at the end of the queue for its priority, for later
+//	scheduling onto the CPU.
 //
 //	"thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
 
 void Scheduler::ReadyToRun(Thread *thread) {
+    int priority = thread->getPriority();
+    int level = (zeroLevel + priority) % NumPriorities;
+
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
+    ASSERT(priority >= 0 && priority < NumPriorities);
 
     thread->setStatus(READY);
-    readyList->SortedInsert((void *)thread, thread->getPriority());
+    readyList[level].Append(thread);
+    readyMask[level / MaskBits] |= 1u << (level % MaskBits);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::FirstReady
+// 	Return the first queue in readyList[from .. to-1] with any threads
+//	on it, or -1 if they are all empty.  Looks at one word of the
+//	bitmap at a time.
+//----------------------------------------------------------------------
+
+int Scheduler::FirstReady(int from, int to) {
+    for (int w = from / MaskBits; w * MaskBits < to; w++) {
+        unsigned int bits = readyMask[w];
+
+        if (w == from / MaskBits) bits &= ~0u << (from % MaskBits);
+        if (bits != 0) {
+            int level = w * MaskBits + __builtin_ctz(bits);
+            return (level < to) ? level : -1;
+        }
+    }
+    return -1;
+}
+
+#ifdef THREAD_AGING
+//----------------------------------------------------------------------
+// Scheduler::Age
+// 	Raise the priority of every ready thread by one level (the
+//	threads at priority 0 stay there), by making the priority 1
+//	queue the new priority 0 queue.  The threads that were already
+//	at priority 0 have waited longer, so they go in front.
+//----------------------------------------------------------------------
+
+void Scheduler::Age() {
+    int oldZero = zeroLevel;
+
+    zeroLevel = (zeroLevel + 1) % NumPriorities;
+    if (readyList[oldZero].IsEmpty()) return;
+
+    readyList[oldZero].Concatenate(&readyList[zeroLevel]);
+    readyList[zeroLevel].Concatenate(&readyList[oldZero]);
+    readyMask[zeroLevel / MaskBits] |= 1u << (zeroLevel % MaskBits);
+    readyMask[oldZero / MaskBits] &= ~(1u << (oldZero % MaskBits));
 }
+#endif
 
 //----------------------------------------------------------------------
 // Scheduler::FindNextToRun
@@ -61,24 +122,25 @@ void Scheduler::ReadyToRun(Thread *thread) {
 //----------------------------------------------------------------------
 
 Thread *Scheduler::FindNextToRun() {
+    Thread *thread;
+    int level;
+
 #ifdef THREAD_AGING
-    agingTicks++;
-    if (agingTicks >= 100) {
+    if (++agingTicks >= AgingInterval) {
         agingTicks = 0;
-        ListElement *e = readyList->getFirst();
-        while (e != NULL) {
-            Thread *t = (Thread *)e->item;
-            // priority is in range [0, 99], smaller number has higher priority.
-            bool isHighestPriority = t->getPriority() == 0;
-            if (!isHighestPriority) {
-                t->setPriority(t->getPriority() - 1);
-            }
-            e = e->next;
-        }
+        Age();
     }
-#else
-    return (Thread *)readyList->Remove();
 #endif
+    level = FirstReady(zeroLevel, NumPriorities);  // priorities in order,
+    if (level < 0) level = FirstReady(0, zeroLevel);  // round the ring
+    if (level < 0) return NULL;
+
+    thread = readyList[level].Remove();
+    if (readyList[level].IsEmpty())
+        readyMask[level / MaskBits] &= ~(1u << (level % MaskBits));
+    // the thread keeps whatever priority it has aged to
+    thread->setPriority((level - zeroLevel + NumPriorities) % NumPriorities);
+    return thread;
 }
 
 //----------------------------------------------------------------------
@@ -147,5 +209,7 @@ void Scheduler::Run(Thread *nextThread) {
 //----------------------------------------------------------------------
 void Scheduler::Print() {
     printf("Ready list contents:\n");
-    readyList->Mapcar((VoidFunctionPtr)ThreadPrint);
+    for (int p = 0; p < NumPriorities; p++)
+        readyList[(zeroLevel + p) % NumPriorities].Mapcar(
+            (VoidFunctionPtr)ThreadPrint);
 }
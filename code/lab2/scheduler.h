@@ -13,6 +13,19 @@
 #include "list.h"
 #include "thread.h"
 
+// Thread priorities run from 0 (highest) to NumPriorities - 1 (lowest).
+// There is one FIFO run queue per priority, and a bitmap of the
+// non-empty ones, so that finding the next thread to run takes the
+// same time however many threads are ready.
+#define NumPriorities 100
+#define MaskBits 32  // bits in a word of the bitmap
+#define MaskWords ((NumPriorities + MaskBits - 1) / MaskBits)
+
+// With THREAD_AGING, every AgingInterval dispatches all ready threads
+// move up one priority level, so that low priority threads do not
+// starve.
+#define AgingInterval 100
+
 // The following class defines the scheduler/dispatcher abstraction --
 // the data structures and operations needed to keep track of which
 // thread is running, and which threads are ready but not running.
@@ -28,12 +41,23 @@ class Scheduler {
     void Run(Thread* nextThread);     // Cause nextThread to start running
     void Print();                     // Print contents of ready list
 
+    bool SliceExpired() { return TRUE; }  // Switch threads on every
+                                          // timer interrupt
+
    private:
-    List* readyList;  // queue of threads that are ready to run,
-                      // but not running
-   #ifdef THREAD_AGING
-      int agingTicks;
-   #endif
+    ThreadQueue* readyList;  // queues of threads that are ready to run,
+                             // but not running, one per priority
+    unsigned int readyMask[MaskWords];  // bit set for each non-empty
+                                        // queue in readyList
+    int zeroLevel;  // the queue holding priority 0; priority p is
+                    // in readyList[(zeroLevel + p) % NumPriorities]
+#ifdef THREAD_AGING
+    int agingTicks;  // dispatches since threads last aged
+    void Age();      // Raise the priority of all ready threads by one
+#endif
+
+    int FirstReady(int from, int to);  // First non-empty queue in
+                                       // [from, to), -1 if none
 };
 
 #endif  // SCHEDULER_H
@@ -26,6 +26,39 @@
                 // execution stack, for detecting
                 // stack overflows
 
+int stackPoolLimit = DefaultStackPoolLimit;  // most stacks kept for reuse
+static int *freeStacks = NULL;  // the stacks kept, linked through
+                                // their first word
+static int numFreeStacks = 0;
+
+//----------------------------------------------------------------------
+// AllocStack, FreeStack
+// 	Get a thread execution stack, from the stacks of finished threads
+//	if there are any; and keep the stack of a finished thread for
+//	reuse, if there are fewer than stackPoolLimit kept already.
+//	Otherwise, go to AllocBoundedArray and DeallocBoundedArray.
+//----------------------------------------------------------------------
+
+static int *AllocStack() {
+    int *stack = freeStacks;
+
+    if (stack == NULL)
+        return (int *)AllocBoundedArray(StackSize * sizeof(_int));
+    freeStacks = *(int **)stack;
+    numFreeStacks--;
+    return stack;
+}
+
+static void FreeStack(int *stack) {
+    if (numFreeStacks >= stackPoolLimit) {
+        DeallocBoundedArray((char *)stack, StackSize * sizeof(_int));
+        return;
+    }
+    *(int **)stack = freeStacks;
+    freeStacks = stack;
+    numFreeStacks++;
+}
+
 //----------------------------------------------------------------------
 // Thread::Thread
 // 	Initialize a thread control block, so that we can then call
@@ -39,6 +72,7 @@ Thread::Thread(const char *threadName) {
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    queueNext = NULL;
 #ifdef THREAD_PRIORITY
     this->priority = 9;  // default priority is 9
 #endif
@@ -52,6 +86,7 @@ Thread::Thread(const char *threadName, THREAD_PRIORITY priority_) {
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    queueNext = NULL;
     // make sure priority is in range [0, 99]
     priority_ = (priority_ < 0) ? 0 : (priority_ > 99) ? 99 : priority_;
     this->priority = priority_;
@@ -76,8 +111,7 @@ Thread::~Thread() {
 #endif
 
     ASSERT(this != currentThread);
-    if (stack != NULL)
-        DeallocBoundedArray((char *)stack, StackSize * sizeof(_int));
+    if (stack != NULL) FreeStack(stack);
 }
 
 //----------------------------------------------------------------------
@@ -263,7 +297,7 @@ void ThreadPrint(_int arg) {
 //----------------------------------------------------------------------
 
 void Thread::StackAllocate(VoidFunctionPtr func, _int arg) {
-    stack = (int *)AllocBoundedArray(StackSize * sizeof(_int));
+    stack = AllocStack();
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
@@ -395,3 +429,62 @@ void Thread::RestoreUserState() {
         machine->WriteRegister(i, userRegisters[i]);
 }
 #endif
+
+//----------------------------------------------------------------------
+// ThreadQueue::Append
+//      Put a thread at the end of the queue, by linking it through its
+//	own "queueNext" field.
+//----------------------------------------------------------------------
+
+void ThreadQueue::Append(Thread *thread) {
+    ASSERT(thread->queueNext == NULL && thread != last);
+
+    if (first == NULL)
+        first = thread;
+    else
+        last->queueNext = thread;
+    last = thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Remove
+//      Take the thread at the front of the queue off it.
+//
+// Returns:
+//	The removed thread, NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+Thread *ThreadQueue::Remove() {
+    Thread *thread = first;
+
+    if (thread == NULL) return NULL;
+    first = thread->queueNext;
+    if (first == NULL) last = NULL;
+    thread->queueNext = NULL;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Concatenate
+//      Move all the threads of another queue, in order, to the end of
+//	this one, leaving the other queue empty.  O(1).
+//----------------------------------------------------------------------
+
+void ThreadQueue::Concatenate(ThreadQueue *other) {
+    if (other->first == NULL) return;
+    if (first == NULL)
+        first = other->first;
+    else
+        last->queueNext = other->first;
+    last = other->last;
+    other->first = other->last = NULL;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Mapcar
+//	Apply a function to each thread on the queue, front to back.
+//----------------------------------------------------------------------
+
+void ThreadQueue::Mapcar(VoidFunctionPtr func) {
+    for (Thread *t = first; t != NULL; t = t->queueNext) (*func)((_int)t);
+}
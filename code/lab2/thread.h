@@ -54,6 +54,12 @@
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 #define StackSize (sizeof(_int) * 1024)  // in words
 
+// Stacks of finished threads are kept for the next Fork, rather than
+// handed back to the host, as allocating a fenced stack costs a couple
+// of mprotect calls.  At most stackPoolLimit of them are kept (-sp).
+#define DefaultStackPoolLimit 16
+extern int stackPoolLimit;
+
 #ifndef THREAD_PRIORITY
 #define THREAD_PRIORITY int     // type of thread priority
 #endif
@@ -121,6 +127,9 @@ class Thread {
                           // (If NULL, don't deallocate stack)
     ThreadStatus status;  // ready, running or blocked
     char* name;
+    Thread* queueNext;    // next thread on the ThreadQueue this
+                          // thread is waiting on, if any
+    friend class ThreadQueue;
 
     void StackAllocate(VoidFunctionPtr func, _int arg);
     // Allocate a stack for thread.
@@ -141,6 +150,33 @@ class Thread {
 #endif
 };
 
+// The following class defines a FIFO queue of threads: the ready list,
+// and the threads waiting on a semaphore or a condition variable.
+//
+// Unlike a List, it keeps its links in the threads themselves, so that
+// putting a thread on the queue and taking it off never allocates or
+// frees memory.  A thread can be on at most one ThreadQueue at a time,
+// which holds since a thread is either ready or blocked on one thing.
+
+class ThreadQueue {
+   public:
+    ThreadQueue() { first = last = NULL; }  // initialize the queue
+
+    void Append(Thread* thread);   // Put thread at the end of the queue
+    Thread* Remove();              // Take thread off the front of the queue,
+                                   // NULL if the queue is empty
+    void Concatenate(ThreadQueue* other);  // Move all of "other"'s threads
+                                           // to the end of this queue
+    bool IsEmpty() { return first == NULL; }
+
+    void Mapcar(VoidFunctionPtr func);  // Apply "func" to every thread
+                                        // on the queue
+
+   private:
+    Thread* first;  // Head of the queue, NULL if the queue is empty
+    Thread* last;   // Last thread on the queue
+};
+
 // Magical machine-dependent routines, defined in switch.s
 
 extern "C" {
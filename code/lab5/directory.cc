@@ -7,14 +7,18 @@
 //	of each directory entry means that we have the restriction
 //	of a fixed maximum size for file names.
 //
+//	The table is kept as a hash table: a name lives in the slot
+//	its hash picks, or in the first free slot after that (linear
+//	probing).  Keeping the table at most three quarters full makes
+//	a lookup look at a slot or two, rather than every entry.
+//
 //	The constructor initializes an empty directory of a certain size;
 //	we use ReadFrom/WriteBack to fetch the contents of the directory
 //	from disk, and to write back any modifications back to disk.
-//
-//	Also, this implementation has the restriction that the size
-//	of the directory cannot expand.  In other words, once all the
-//	entries in the directory are used, no more files can be created.
-//	Fixing this is one of the parts to the assignment.
+//	The size of the table on disk is the length of the directory
+//	file.  Once the table is IsFull(), the caller grows the file by
+//	FileSize() bytes and calls Grow() to double the table, before
+//	adding any more names.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -25,6 +29,22 @@
 #include "filehdr.h"
 #include "directory.h"
 
+//----------------------------------------------------------------------
+// HashName
+// 	Hash a file name, looking at no more than FileNameMaxLen
+//	characters (names are compared the same way).
+//----------------------------------------------------------------------
+
+static unsigned int
+HashName(char *name)
+{
+    unsigned int hash = 5381;
+
+    for (int i = 0; i < FileNameMaxLen && name[i] != '\0'; i++)
+	hash = hash * 33 + (unsigned char) name[i];
+    return hash;
+}
+
 //----------------------------------------------------------------------
 // Directory::Directory
 // 	Initialize a directory; initially, the directory is completely
@@ -41,6 +61,9 @@ Directory::Directory(int size)
     tableSize = size;
     for (int i = 0; i < tableSize; i++)
 	table[i].inUse = FALSE;
+    numUsed = 0;
+    dirtyFirst = 0;			// all of it, should it be written
+    dirtyLast = tableSize - 1;
 }
 
 //----------------------------------------------------------------------
@@ -55,7 +78,8 @@ Directory::~Directory()
 
 //----------------------------------------------------------------------
 // Directory::FetchFrom
-// 	Read the contents of the directory from disk.
+// 	Read the contents of the directory from disk.  The table takes
+//	the size of the directory file.
 //
 //	"file" -- file containing the directory contents
 //----------------------------------------------------------------------
@@ -63,12 +87,27 @@ Directory::~Directory()
 void
 Directory::FetchFrom(OpenFile *file)
 {
+    int size = file->Length() / sizeof(DirectoryEntry);
+
+    if (size != tableSize) {
+	delete [] table;
+	table = new DirectoryEntry[size];
+	tableSize = size;
+    }
     (void) file->ReadAt((char *)table, tableSize * sizeof(DirectoryEntry), 0);
+    numUsed = 0;
+    for (int i = 0; i < tableSize; i++)
+	if (table[i].inUse)
+	    numUsed++;
+    dirtyFirst = tableSize;		// nothing changed yet
+    dirtyLast = -1;
 }
 
 //----------------------------------------------------------------------
 // Directory::WriteBack
-// 	Write any modifications to the directory back to disk
+// 	Write any modifications to the directory back to disk.  Only the
+//	entries changed since FetchFrom are written.  The file must
+//	already be FileSize() bytes long.
 //
 //	"file" -- file to contain the new directory contents
 //----------------------------------------------------------------------
@@ -76,13 +115,47 @@ Directory::FetchFrom(OpenFile *file)
 void
 Directory::WriteBack(OpenFile *file)
 {
-    (void) file->WriteAt((char *)table, tableSize * sizeof(DirectoryEntry), 0);
+    ASSERT(file->Length() >= FileSize());
+    if (dirtyFirst > dirtyLast)
+	return;
+    (void) file->WriteAt((char *)&table[dirtyFirst],
+		(dirtyLast - dirtyFirst + 1) * sizeof(DirectoryEntry),
+		dirtyFirst * sizeof(DirectoryEntry));
+    dirtyFirst = tableSize;
+    dirtyLast = -1;
+}
+
+//----------------------------------------------------------------------
+// Directory::FileSize
+// 	Return the number of bytes the directory takes up on disk.
+//----------------------------------------------------------------------
+
+int
+Directory::FileSize()
+{
+    return tableSize * sizeof(DirectoryEntry);
+}
+
+//----------------------------------------------------------------------
+// Directory::MarkDirty
+// 	Note that entry "i" has changed and must be written back.
+//----------------------------------------------------------------------
+
+void
+Directory::MarkDirty(int i)
+{
+    if (i < dirtyFirst)
+	dirtyFirst = i;
+    if (i > dirtyLast)
+	dirtyLast = i;
 }
 
 //----------------------------------------------------------------------
 // Directory::FindIndex
 // 	Look up file name in directory, and return its location in the table of
 //	directory entries.  Return -1 if the name isn't in the directory.
+//	The search starts at the slot the name hashes to, and stops at
+//	the first free slot.
 //
 //	"name" -- the file name to look up
 //----------------------------------------------------------------------
@@ -90,9 +163,14 @@ Directory::WriteBack(OpenFile *file)
 int
 Directory::FindIndex(char *name)
 {
-    for (int i = 0; i < tableSize; i++)
-        if (table[i].inUse && !strncmp(table[i].name, name, FileNameMaxLen))
+    int i = HashName(name) % tableSize;
+
+    for (int n = 0; n < tableSize; n++, i = (i + 1) % tableSize) {
+	if (!table[i].inUse)
+	    break;
+	if (!strncmp(table[i].name, name, FileNameMaxLen))
 	    return i;
+    }
     return -1;		// name not in directory
 }
 
@@ -115,31 +193,94 @@ Directory::Find(char *name)
     return -1;
 }
 
+//----------------------------------------------------------------------
+// Directory::IsDir
+// 	Return TRUE if "name" is in the directory and is itself a
+//	directory.
+//
+//	"name" -- the file name to look up
+//----------------------------------------------------------------------
+
+bool
+Directory::IsDir(char *name)
+{
+    int i = FindIndex(name);
+
+    return (i != -1) && table[i].isDir;
+}
+
+//----------------------------------------------------------------------
+// Directory::IsFull
+// 	Return TRUE if the table is too full to take another name, and
+//	must Grow first.  We keep it at most three quarters full.
+//----------------------------------------------------------------------
+
+bool
+Directory::IsFull()
+{
+    return 4 * (numUsed + 1) > 3 * tableSize;
+}
+
+//----------------------------------------------------------------------
+// Directory::Grow
+// 	Double the size of the table, rehashing every entry into it.
+//	The whole table must then be written back, so the directory
+//	file has to be grown to the new FileSize() first.
+//----------------------------------------------------------------------
+
+void
+Directory::Grow()
+{
+    DirectoryEntry *old = table;
+    int oldSize = tableSize;
+    int i, j;
+
+    tableSize = 2 * oldSize;
+    table = new DirectoryEntry[tableSize];
+    for (i = 0; i < tableSize; i++)
+	table[i].inUse = FALSE;
+    for (i = 0; i < oldSize; i++)
+	if (old[i].inUse) {
+	    j = HashName(old[i].name) % tableSize;
+	    while (table[j].inUse)
+		j = (j + 1) % tableSize;
+	    table[j] = old[i];
+	}
+    delete [] old;
+    dirtyFirst = 0;
+    dirtyLast = tableSize - 1;
+}
+
 //----------------------------------------------------------------------
 // Directory::Add
 // 	Add a file into the directory.  Return TRUE if successful;
 //	return FALSE if the file name is already in the directory, or if
-//	the directory is completely full, and has no more space for
-//	additional file names.
+//	the table IsFull() and has to Grow first.
 //
 //	"name" -- the name of the file being added
 //	"newSector" -- the disk sector containing the added file's header
+//	"isDir" -- is the file being added a directory?
 //----------------------------------------------------------------------
 
 bool
-Directory::Add(char *name, int newSector)
+Directory::Add(char *name, int newSector, bool isDir)
 { 
-    if (FindIndex(name) != -1)
+    int i;
+
+    if (FindIndex(name) != -1 || IsFull())
 	return FALSE;
 
-    for (int i = 0; i < tableSize; i++)
-        if (!table[i].inUse) {
-            table[i].inUse = TRUE;
-            strncpy(table[i].name, name, FileNameMaxLen); 
-            table[i].sector = newSector;
-        return TRUE;
-	}
-    return FALSE;	// no space.  Fix when we have extensible files.
+    i = HashName(name) % tableSize;
+    while (table[i].inUse)
+	i = (i + 1) % tableSize;
+    table[i].inUse = TRUE;
+    table[i].isDir = isDir;
+    strncpy(table[i].name, name, FileNameMaxLen); 
+    table[i].name[FileNameMaxLen] = '\0';
+    table[i].sector = newSector;
+    numUsed++;
+    MarkDirty(i);
+    return TRUE;
 }
 
 //----------------------------------------------------------------------
@@ -147,6 +288,10 @@ Directory::Add(char *name, int newSector)
 // 	Remove a file name from the directory.  Return TRUE if successful;
 //	return FALSE if the file isn't in the directory. 
 //
+//	Entries after the hole that could have been placed in it are
+//	moved back into it, so that lookups never stop short at a free
+//	slot in the middle of a run.
+//
 //	"name" -- the file name to be removed
 //----------------------------------------------------------------------
 
@@ -154,24 +299,66 @@ bool
 Directory::Remove(char *name)
 { 
     int i = FindIndex(name);
+    int j, k;
 
     if (i == -1)
 	return FALSE; 		// name not in directory
     table[i].inUse = FALSE;
+    numUsed--;
+    MarkDirty(i);
+    for (j = (i + 1) % tableSize; table[j].inUse; j = (j + 1) % tableSize) {
+	k = HashName(table[j].name) % tableSize;
+	if ((i < j) ? (i < k && k <= j) : (i < k || k <= j))
+	    continue;			// already as close as it can be
+	table[i] = table[j];
+	table[j].inUse = FALSE;
+	MarkDirty(i);
+	MarkDirty(j);
+	i = j;
+    }
     return TRUE;	
 }
 
+//----------------------------------------------------------------------
+// Directory::IsEmpty
+// 	Return TRUE if no files are left in the directory.
+//----------------------------------------------------------------------
+
+bool
+Directory::IsEmpty()
+{
+    return numUsed == 0;
+}
+
 //----------------------------------------------------------------------
 // Directory::List
-// 	List all the file names in the directory. 
+// 	List all the file names in the directory.  Subdirectories are
+//	shown with a trailing '/', followed by their contents indented.
 //----------------------------------------------------------------------
 
 void
 Directory::List()
+{
+    ListIndented(0);
+}
+
+void
+Directory::ListIndented(int depth)
 {
    for (int i = 0; i < tableSize; i++)
-	if (table[i].inUse)
-	    printf("%s\n", table[i].name);
+	if (table[i].inUse) {
+	    printf("%*s%s%s\n", 2 * depth, "", table[i].name,
+		   table[i].isDir ? "/" : "");
+	    if (table[i].isDir) {
+		OpenFile *file = new OpenFile(table[i].sector);
+		Directory *sub = new Directory(NumDirEntries);
+
+		sub->FetchFrom(file);
+		sub->ListIndented(depth + 1);
+		delete sub;
+		delete file;
+	    }
+	}
 }
 
 //----------------------------------------------------------------------
@@ -188,9 +375,19 @@ Directory::Print()
     printf("Directory contents:\n");
     for (int i = 0; i < tableSize; i++)
 	if (table[i].inUse) {
-	    printf("Name: %s, Sector: %d\n", table[i].name, table[i].sector);
+	    printf("Name: %s, Sector: %d%s\n", table[i].name, table[i].sector,
+		   table[i].isDir ? ", Directory" : "");
 	    hdr->FetchFrom(table[i].sector);
 	    hdr->Print();
+	    if (table[i].isDir) {
+		OpenFile *file = new OpenFile(table[i].sector);
+		Directory *sub = new Directory(NumDirEntries);
+
+		sub->FetchFrom(file);
+		sub->Print();
+		delete sub;
+		delete file;
+	    }
 	}
     printf("\n");
     delete hdr;
@@ -198,8 +395,6 @@ Directory::Print()
 
 void
 Directory::DiskMessage(){
-    FileHeader *hdr = new FileHeader;
-    BitMap *bitmap;
     int sectorSum = 0;
     int fileSize = 0;
     int count=0;
@@ -207,26 +402,126 @@ Directory::DiskMessage(){
     int sectorsFragmentation = 0;
     int fragmentation = 0;
 
+    Tally(&count, &fileSize, &sectorSum, &fragmentation, &sectorsFragmentation);
+
+    printf("%d bytes in %d files, occupy %d bytes(%d sectors). \n", fileSize, count, sectorSum*128, sectorSum);
+    printf("%d bytes of internal fragmentation in %d sectors. \n", fragmentation, sectorsFragmentation);
+}
+
+void
+Directory::Tally(int *count, int *fileSize, int *sectorSum,
+		 int *fragmentation, int *sectorsFragmentation){
+    FileHeader *hdr = new FileHeader;
+
     for (int i = 0; i < tableSize; i++)
         if (table[i].inUse) {
-            count++;
-            // printf("Name: %s, Sector: %d\n", table[i].name, table[i].sector);
             hdr->FetchFrom(table[i].sector);
-            sectorSum += hdr->getSecNum();
-            fileSize += hdr->FileLength();
+            if (table[i].isDir) {
+                OpenFile *file = new OpenFile(table[i].sector);
+                Directory *sub = new Directory(NumDirEntries);
+
+                sub->FetchFrom(file);
+                sub->Tally(count, fileSize, sectorSum, fragmentation,
+                           sectorsFragmentation);
+                delete sub;
+                delete file;
+                continue;
+            }
+            (*count)++;
+            *sectorSum += hdr->getSecNum();
+            *fileSize += hdr->FileLength();
 
-            if(fileSize%128 == 0){
-                sectorsFragmentation += 0;
+            if(*fileSize%128 == 0){
+                *sectorsFragmentation += 0;
             }else{
-                fragmentation += hdr->getSecNum()*128 - hdr->FileLength();
-                sectorsFragmentation +=  1;
+                *fragmentation += hdr->getSecNum()*128 - hdr->FileLength();
+                *sectorsFragmentation +=  1;
             }
-            //hdr->Print();
         }
 
-    printf("%d bytes in %d files, occupy %d bytes(%d sectors). \n", fileSize, count, sectorSum*128, sectorSum);
-    printf("%d bytes of internal fragmentation in %d sectors. \n", fragmentation, sectorsFragmentation);
+    delete hdr;
+}
 
+//----------------------------------------------------------------------
+// DentryCache::DentryCache
+// 	Initialize the lookup cache, with every slot empty.
+//----------------------------------------------------------------------
 
-    delete hdr;
-}
\ No newline at end of file
+DentryCache::DentryCache()
+{
+    for (int i = 0; i < DentryCacheSize; i++)
+	table[i].dirSector = -1;
+}
+
+//----------------------------------------------------------------------
+// DentryCache::Slot
+// 	Return the slot that <dirSector, name> is cached in, if anywhere.
+//----------------------------------------------------------------------
+
+int
+DentryCache::Slot(int dirSector, char *name)
+{
+    return (HashName(name) + 31 * dirSector) % DentryCacheSize;
+}
+
+//----------------------------------------------------------------------
+// DentryCache::Lookup
+// 	Return the sector of the file header for "name" in the directory
+//	whose header is at "dirSector", and whether it is a directory.
+//	Return -1 if the lookup is not cached.
+//----------------------------------------------------------------------
+
+int
+DentryCache::Lookup(int dirSector, char *name, bool *isDir)
+{
+    Dentry *d = &table[Slot(dirSector, name)];
+
+    if (d->dirSector != dirSector || strncmp(d->name, name, FileNameMaxLen))
+	return -1;
+    *isDir = d->isDir;
+    return d->sector;
+}
+
+//----------------------------------------------------------------------
+// DentryCache::Enter
+// 	Remember that "name" in directory "dirSector" has its header at
+//	"sector".
+//----------------------------------------------------------------------
+
+void
+DentryCache::Enter(int dirSector, char *name, int sector, bool isDir)
+{
+    Dentry *d = &table[Slot(dirSector, name)];
+
+    d->dirSector = dirSector;
+    strncpy(d->name, name, FileNameMaxLen);
+    d->name[FileNameMaxLen] = '\0';
+    d->sector = sector;
+    d->isDir = isDir;
+}
+
+//----------------------------------------------------------------------
+// DentryCache::Forget
+// 	Drop the cached lookup of "name" in directory "dirSector", if any.
+//----------------------------------------------------------------------
+
+void
+DentryCache::Forget(int dirSector, char *name)
+{
+    Dentry *d = &table[Slot(dirSector, name)];
+
+    if (d->dirSector == dirSector && !strncmp(d->name, name, FileNameMaxLen))
+	d->dirSector = -1;
+}
+
+//----------------------------------------------------------------------
+// DentryCache::Clear
+// 	Drop every cached lookup.
+//----------------------------------------------------------------------
+
+void
+DentryCache::Clear()
+{
+    for (int i = 0; i < DentryCacheSize; i++)
+	table[i].dirSector = -1;
+}
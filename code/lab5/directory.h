@@ -4,7 +4,11 @@
 //      A directory is a table of pairs: <file name, sector #>,
 //	giving the name of each file in the directory, and 
 //	where to find its file header (the data structure describing
-//	where to find the file's data blocks) on disk.
+//	where to find the file's data blocks) on disk.  An entry can
+//	also name another directory, so directories form a tree.
+//
+//	The table is a hash table on the file name, and doubles in
+//	size when it gets three quarters full.
 //
 //      We assume mutual exclusion is provided by the caller.
 //
@@ -21,6 +25,8 @@
 
 #define FileNameMaxLen 		9	// for simplicity, we assume 
 					// file names are <= 9 characters long
+#define NumDirEntries 		10	// size of a newly made directory
+#define DentryCacheSize 	64	// entries in the lookup cache
 
 // The following class defines a "directory entry", representing a file
 // in the directory.  Each entry gives the name of the file, and where
@@ -32,6 +38,7 @@
 class DirectoryEntry {
   public:
     bool inUse;				// Is this directory entry in use?
+    bool isDir;				// Does it name a subdirectory?
     int sector;				// Location on disk to find the 
 					//   FileHeader for this file 
     char name[FileNameMaxLen + 1];	// Text name for file, with +1 for 
@@ -57,13 +64,19 @@ class Directory {
     void FetchFrom(OpenFile *file);  	// Init directory contents from disk
     void WriteBack(OpenFile *file);	// Write modifications to 
 					// directory contents back to disk
+    int FileSize();			// Bytes the directory needs on disk
 
     int Find(char *name);		// Find the sector number of the 
 					// FileHeader for file: "name"
+    bool IsDir(char *name);		// Is "name" a subdirectory?
 
-    bool Add(char *name, int newSector);  // Add a file name into the directory
+    bool Add(char *name, int newSector, bool isDir);
+					// Add a file name into the directory
+    bool IsFull();			// Must the table grow before Add?
+    void Grow();			// Double the size of the table
 
     bool Remove(char *name);		// Remove a file from the directory
+    bool IsEmpty();			// Are there no files left?
 
     void List();			// Print the names of all the files
 					//  in the directory
@@ -76,9 +89,52 @@ class Directory {
     int tableSize;			// Number of directory entries
     DirectoryEntry *table;		// Table of pairs: 
 					// <file name, file header location> 
+    int numUsed;			// Number of entries in use
+    int dirtyFirst, dirtyLast;		// Entries changed since FetchFrom
 
     int FindIndex(char *name);		// Find the index into the directory 
 					//  table corresponding to "name"
+    void MarkDirty(int i);		// Entry "i" must be written back
+    void ListIndented(int depth);	// List, nested "depth" levels down
+    void Tally(int *count, int *fileSize, int *sectorSum,
+	       int *fragmentation, int *sectorsFragmentation);
+					// Add up the files for DiskMessage
+};
+
+// The following class caches recent name lookups, so that resolving
+// a path does not have to read every directory along the way.  Each
+// entry maps <directory header sector, name> to the file it names.
+// The cache is direct mapped; a new entry simply replaces whatever
+// was in its slot.
+
+class Dentry {
+  public:
+    int dirSector;			// Directory holding the name, or -1
+					//   if the slot is empty
+    int sector;				// FileHeader of the file named
+    bool isDir;				// Is the file a directory?
+    char name[FileNameMaxLen + 1];	// Name within the directory
+};
+
+class DentryCache {
+  public:
+    DentryCache();			// Initialize an empty cache
+
+    int Lookup(int dirSector, char *name, bool *isDir);
+					// Return the sector of "name" in the
+					//   directory, or -1 if not cached
+    void Enter(int dirSector, char *name, int sector, bool isDir);
+					// Remember a lookup
+    void Forget(int dirSector, char *name);
+					// Drop "name", when it is removed
+    void Clear();			// Drop every lookup, when the
+					//   directories were changed behind
+					//   the cache's back (-fsck)
+
+  private:
+    Dentry table[DentryCacheSize];
+
+    int Slot(int dirSector, char *name);	// Where <dir, name> goes
 };
 
 #endif // DIRECTORY_H
@@ -3,12 +3,14 @@
 //	would be called the i-node).
 //
 //	The file header is used to locate where on disk the
-//	file's data is stored.  We implement this as a fixed size
-//	table of pointers -- each entry in the table points to the
-//	disk sector containing that portion of the file data
-//	(in other words, there are no indirect or doubly indirect
-//	blocks). The table size is chosen so that the file header
-//	will be just big enough to fit in one disk sector,
+//	file's data is stored.  We implement this as a table of
+//	extents -- each entry describes a run of consecutive disk
+//	sectors holding that portion of the file data.  The first
+//	few extents live in the file header itself, the rest in a
+//	chain of extent blocks.  Growing a file extends its last
+//	extent when the sectors after it are free, so a file written
+//	in one go usually ends up in a single run and can be read
+//	back without seeking.
 //
 //      Unlike in a real system, we do not keep track of file permissions,
 //	ownership, last modification date, etc., in the file header.
@@ -27,8 +29,51 @@
 #include <time.h>
 
 #include "copyright.h"
+#include "journal.h"
 #include "system.h"
 
+//----------------------------------------------------------------------
+// FreeRun
+// 	Return the number of free sectors starting at "sector", looking
+//	at no more than "limit" of them.
+//----------------------------------------------------------------------
+
+static int FreeRun(BitMap *freeMap, int sector, int limit) {
+    int n = 0;
+
+    while (n < limit && sector + n < NumSectors && !freeMap->Test(sector + n))
+        n++;
+    return n;
+}
+
+//----------------------------------------------------------------------
+// ClaimRun
+// 	Choose where the next "want" sectors of a file should go, and mark
+//	them in use.  Sectors right after "near" (the end of the file's
+//	last extent) are taken if any are free, so the extent simply
+//	grows.  Otherwise we take the first free run long enough for all
+//	of them, scanning forward from "near" and wrapping around, or
+//	failing that, the longest run on the disk.
+//
+//	Returns the length of the run chosen (at most "want"; 0 if the
+//	disk is full), and its first sector in "start".
+//----------------------------------------------------------------------
+
+static int ClaimRun(BitMap *freeMap, int near, int want, int *start) {
+    int n = (near < NumSectors) ? FreeRun(freeMap, near, want) : 0;
+
+    if (n > 0) {
+        for (int i = 0; i < n; i++) freeMap->Mark(near + i);
+        *start = near;
+        return n;
+    }
+    if (near >= NumSectors) near = 0;
+    if ((*start = freeMap->FindRun(want, near)) != -1) return want;
+    n = freeMap->LongestRun(near, start);  // shorter than "want"
+    for (int i = 0; i < n; i++) freeMap->Mark(*start + i);
+    return n;
+}
+
 //----------------------------------------------------------------------
 // FileHeader::Allocate
 // 	Initialize a fresh file header for a newly created file.
@@ -37,74 +82,201 @@
 //	the new file.
 //
 //	"freeMap" is the bit map of free disk sectors
-//	"fileSize" is the bit map of free disk sectors
+//	"fileSize" is the size of the new file in bytes
 //----------------------------------------------------------------------
 
 bool FileHeader::Allocate(BitMap *freeMap, int fileSize) {
+    numBytes = 0;
+    numExtents = 0;
+    moreExtents = -1;
+    if (!AddSectors(freeMap, divRoundUp(fileSize, SectorSize)))
+        return FALSE;  // not enough space
     numBytes = fileSize;
-    printf("fileSize: %d \n", fileSize);
-    // numSectors = divRoundUp(fileSize, SectorSize);
-    printf("numSectors: %d \n", getSecNum());
+    return TRUE;
+}
 
-    if (freeMap->NumClear() < getSecNum())
-        return FALSE;  // not enough space
-    else if (NumDirect + NumDirect2 <= getSecNum())
-        return FALSE;  // second index do not have enough space
+//----------------------------------------------------------------------
+// FileHeader::AddSectors
+// 	Allocate "count" more data sectors at the end of the file, as
+//	few extents as the free map allows.  All the space, including
+//	any extent blocks needed to describe it, is claimed before the
+//	header is touched, so on failure the free map and the header are
+//	left as they were and FALSE is returned.
+//
+//	"freeMap" is the bit map of free disk sectors
+//	"count" is the number of sectors to add
+//----------------------------------------------------------------------
 
-    int lastIndex = NumDirect - 1;  // the last one of the first index
-    if (getSecNum() < lastIndex) {
-        for (int i = 0; i < getSecNum(); i++) {
-            dataSectors[i] = freeMap->Find();  // Allocate sectors
-        }
-        dataSectors[lastIndex] = -1;  // the last one of the first inode is -1
-        printf("************Now the last is: %d***************** \n",
-               dataSectors[lastIndex]);
+bool FileHeader::AddSectors(BitMap *freeMap, int count) {
+    Extent last, *runs;
+    ExtentBlock block;
+    int *blocks;
+    int numRuns, numBlocks, oldBlocks, total, merged;
+    int near, start, n, i, j;
+    bool ok = TRUE;
 
-    } else {
-        for (int i = 0; i < lastIndex; i++) {
-            dataSectors[i] = freeMap->Find();  // Allocate sectors
-        }
-        dataSectors[lastIndex] =
-            freeMap->Find();  // find a sector for the second inode
+    if (count <= 0) return TRUE;
+    if (freeMap->NumClear() < count) return FALSE;
 
-        int dataSector2[NumDirect2];
-        for (int i = 0; i < getSecNum() - NumDirect; i++) {
-            dataSector2[i] = freeMap->Find();  // Allocate sectors
+    near = 0;
+    if (numExtents > 0) {
+        last = GetExtent(numExtents - 1);
+        near = last.start + last.length;
+    }
+    runs = new Extent[count];
+    for (numRuns = 0; count > 0; numRuns++) {
+        n = ClaimRun(freeMap, near, count, &start);
+        if (n == 0) {
+            ok = FALSE;
+            break;
         }
-        synchDisk->WriteSector(dataSectors[lastIndex],
-                               (char *)dataSector2);  // write back to the disk
+        runs[numRuns].start = start;
+        runs[numRuns].length = n;
+        near = start + n;
+        count -= n;
     }
 
+    // a first run that continues the last extent is folded into it
+    merged = (ok && numExtents > 0 && runs[0].start == last.start + last.length)
+                 ? 1
+                 : 0;
+    total = numExtents + numRuns - merged;
+    oldBlocks = (numExtents <= NumExtents)
+                    ? 0
+                    : divRoundUp(numExtents - NumExtents, ExtentsPerSector);
+    numBlocks = (total <= NumExtents)
+                    ? 0
+                    : divRoundUp(total - NumExtents, ExtentsPerSector);
+    numBlocks -= oldBlocks;
+    blocks = new int[numBlocks > 0 ? numBlocks : 1];
+    for (j = 0; ok && j < numBlocks; j++) {
+        blocks[j] = freeMap->Find();
+        if (blocks[j] == -1) ok = FALSE;
+    }
+
+    if (!ok) {  // give back everything claimed above
+        for (i = 0; i < numRuns; i++)
+            for (n = 0; n < runs[i].length; n++)
+                freeMap->Clear(runs[i].start + n);
+        while (--j >= 0)
+            if (blocks[j] != -1) freeMap->Clear(blocks[j]);
+        delete[] runs;
+        delete[] blocks;
+        return FALSE;
+    }
+
+    if (merged) {
+        last.length += runs[0].length;
+        PutExtent(numExtents - 1, last);
+    }
+    for (i = merged, j = 0; i < numRuns; i++) {
+        n = numExtents - NumExtents;  // index within the extent blocks
+        if (n >= 0 && n % ExtentsPerSector == 0) {
+            // start a new extent block and link it onto the chain
+            if (n == 0) {
+                moreExtents = blocks[j];
+            } else {
+                start = ExtentBlockSector(n / ExtentsPerSector - 1);
+                journal->Read(start, (char *)&block);
+                block.next = blocks[j];
+                journal->Write(start, (char *)&block);
+            }
+            block.next = -1;
+            block.unused = 0;
+            journal->Write(blocks[j++], (char *)&block);
+        }
+        numExtents++;
+        PutExtent(numExtents - 1, runs[i]);
+    }
+    delete[] runs;
+    delete[] blocks;
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// FileHeader::ExtentBlockSector
+// 	Return the disk sector holding the n-th extent block of the file,
+//	following the chain from the header.
+//----------------------------------------------------------------------
+
+int FileHeader::ExtentBlockSector(int n) {
+    ExtentBlock block;
+    int sector = moreExtents;
+
+    while (n-- > 0) {
+        journal->Read(sector, (char *)&block);
+        sector = block.next;
+    }
+    ASSERT(sector != -1);
+    return sector;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::GetExtent
+// FileHeader::PutExtent
+// 	Read or replace the i-th extent of the file, wherever it is kept.
+//----------------------------------------------------------------------
+
+Extent FileHeader::GetExtent(int i) {
+    ExtentBlock block;
+
+    ASSERT(i >= 0 && i < numExtents);
+    if (i < NumExtents) return extents[i];
+    i -= NumExtents;
+    journal->Read(ExtentBlockSector(i / ExtentsPerSector), (char *)&block);
+    return block.extents[i % ExtentsPerSector];
+}
+
+void FileHeader::PutExtent(int i, Extent extent) {
+    ExtentBlock block;
+    int sector;
+
+    ASSERT(i >= 0 && i < numExtents);
+    if (i < NumExtents) {
+        extents[i] = extent;
+        return;
+    }
+    i -= NumExtents;
+    sector = ExtentBlockSector(i / ExtentsPerSector);
+    journal->Read(sector, (char *)&block);
+    block.extents[i % ExtentsPerSector] = extent;
+    journal->Write(sector, (char *)&block);
+}
+
 //----------------------------------------------------------------------
 // FileHeader::Deallocate
-// 	De-allocate all the space allocated for data blocks for this file.
+// 	De-allocate all the space allocated for data blocks for this file,
+//	along with the extent blocks describing them.  Changes to any of
+//	them still waiting in the journal (a directory's data, the extent
+//	blocks) are dropped.
 //
 //	"freeMap" is the bit map of free disk sectors
 //----------------------------------------------------------------------
 
 void FileHeader::Deallocate(BitMap *freeMap) {
-    int lastIndex = NumDirect - 1;
-    if (dataSectors[lastIndex] == -1) {  //没用到二级索引的时候的释放
-        for (int i = 0; i < getSecNum(); i++) {
-            ASSERT(freeMap->Test((int)dataSectors[i]));
-            freeMap->Clear((int)dataSectors[i]);
-        }
-    } else {  //用到了二级索引
-        int i;
-        for (i = 0; i < lastIndex; i++) {  //先把一级索引释放了
-            ASSERT(freeMap->Test((int)dataSectors[i]));
-            freeMap->Clear((int)dataSectors[i]);
+    ExtentBlock block;
+    Extent extent;
+    int sector = moreExtents;
+    int i, j;
+
+    for (i = 0; i < numExtents; i++) {
+        j = i - NumExtents;
+        if (j < 0) {
+            extent = extents[i];
+        } else {
+            if (j % ExtentsPerSector == 0) {
+                journal->Read(sector, (char *)&block);
+                ASSERT(freeMap->Test(sector));
+                freeMap->Clear(sector);
+                journal->Forget(sector);
+                sector = block.next;
+            }
+            extent = block.extents[j % ExtentsPerSector];
         }
-        int dataSector2[NumDirect2];
-        synchDisk->ReadSector(dataSectors[lastIndex],
-                              (char *)dataSector2);  //先找到二级索引节点
-        freeMap->Clear((int)dataSectors[lastIndex]);
-        for (i; i < getSecNum(); i++) {
-            freeMap->Clear(
-                (int)dataSector2[i - lastIndex]);  //释放二级索引节点内容
+        for (j = 0; j < extent.length; j++) {
+            ASSERT(freeMap->Test(extent.start + j));
+            freeMap->Clear(extent.start + j);
+            journal->Forget(extent.start + j);
         }
     }
 }
@@ -117,20 +289,20 @@ void FileHeader::Deallocate(BitMap *freeMap) {
 //----------------------------------------------------------------------
 
 void FileHeader::FetchFrom(int sector) {
-    synchDisk->ReadSector(sector, (char *)this);
+    journal->Read(sector, (char *)this);
 }
 
 //----------------------------------------------------------------------
 // FileHeader::WriteBack
-// 	Write the modified contents of the file header back to disk.
+// 	Write the modified contents of the file header back to disk,
+//	by way of the journal.
 //
 //	"sector" is the disk sector to contain the file header
 //----------------------------------------------------------------------
 
 void FileHeader::WriteBack(int sector) {
     // updateTime();
-    synchDisk->WriteSector(sector,
-                           (char *)this);  // TODO HERE: HOW DID THIS WORK ?
+    journal->Write(sector, (char *)this);
 }
 
 //----------------------------------------------------------------------
@@ -144,14 +316,131 @@ void FileHeader::WriteBack(int sector) {
 //----------------------------------------------------------------------
 
 int FileHeader::ByteToSector(int offset) {
-    int lastIndex = NumDirect - 1;
-    if (offset / SectorSize < lastIndex) {
-        return (dataSectors[offset / SectorSize]);
-    } else {
-        int dataSectors2[NumDirect2];
-        synchDisk->ReadSector(dataSectors[lastIndex], (char *)dataSectors2);
-        return (dataSectors2[offset / SectorSize - lastIndex]);
+    ExtentBlock block;
+    Extent extent;
+    int sector = moreExtents;
+    int n = offset / SectorSize;
+    int i, j;
+
+    for (i = 0; i < numExtents; i++) {
+        j = i - NumExtents;
+        if (j < 0) {
+            extent = extents[i];
+        } else {
+            if (j % ExtentsPerSector == 0) {
+                journal->Read(sector, (char *)&block);
+                sector = block.next;
+            }
+            extent = block.extents[j % ExtentsPerSector];
+        }
+        if (n < extent.length) return extent.start + n;
+        n -= extent.length;
+    }
+    ASSERT(FALSE);  // offset is past the end of the file
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::ImageExtents
+// 	Copy the extents of the file into "list", and the sectors of its
+//	extent blocks into "blocks", following the chain of extent blocks
+//	in "image" -- a copy of the whole disk -- rather than on the disk.
+//	Return the number of extent blocks, or -1 if the header or the
+//	chain does not make sense.  Each array needs room for NumSectors.
+//----------------------------------------------------------------------
+
+int FileHeader::ImageExtents(char *image, Extent *list, int *blocks) {
+    ExtentBlock *block = NULL;
+    int sector = moreExtents;
+    int i, j, numBlocks = 0;
+
+    if (numBytes < 0 || numBytes > MaxFileSize || numExtents < 0 ||
+        numExtents > NumSectors)
+        return -1;
+    for (i = 0; i < numExtents; i++) {
+        j = i - NumExtents;
+        if (j < 0) {
+            list[i] = extents[i];
+        } else {
+            if (j % ExtentsPerSector == 0) {
+                if (sector < 0 || sector >= NumSectors) return -1;
+                blocks[numBlocks++] = sector;
+                block = (ExtentBlock *)&image[sector * SectorSize];
+                sector = block->next;
+            }
+            list[i] = block->extents[j % ExtentsPerSector];
+        }
+    }
+    return numBlocks;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::Claim
+// 	For checking a disk: record in "owner" that every sector of the
+//	file -- its extent blocks and its data -- belongs to the header at
+//	"self", taking the extent blocks from "image", a copy of the whole
+//	disk.  Set "numRuns" to the number of extents.
+//
+//	Return -1 if all is well; -2 if the header is damaged; otherwise
+//	the first sector that is not on the disk or already belongs to
+//	something else.  Nothing is recorded unless all is well.
+//----------------------------------------------------------------------
+
+int FileHeader::Claim(char *image, int *owner, int self, int *numRuns) {
+    Extent *list = new Extent[NumSectors];
+    int *blocks = new int[NumSectors];
+    int numBlocks = ImageExtents(image, list, blocks);
+    int i, j, n, bad = -1;
+
+    if (numBlocks < 0) bad = -2;
+    for (i = n = 0; bad == -1 && i < numExtents; i++) {
+        if (list[i].length <= 0) bad = -2;
+        n += list[i].length;
+    }
+    if (bad == -1 && n != getSecNum()) bad = -2;
+    for (i = 0; bad == -1 && i < numBlocks; i++) {
+        if (blocks[i] < 0 || blocks[i] >= NumSectors || owner[blocks[i]] != -1)
+            bad = blocks[i];
+        else
+            owner[blocks[i]] = self;
+    }
+    for (i = 0; bad == -1 && i < numExtents; i++)
+        for (j = 0; bad == -1 && j < list[i].length; j++) {
+            n = list[i].start + j;
+            if (n < 0 || n >= NumSectors || owner[n] != -1)
+                bad = n;
+            else
+                owner[n] = self;
+        }
+    if (bad != -1)  // hand back what was claimed
+        for (i = 0; i < NumSectors; i++)
+            if (owner[i] == self && i != self) owner[i] = -1;
+    *numRuns = numExtents;
+    delete[] list;
+    delete[] blocks;
+    return bad;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::ReadImage
+// 	Copy the contents of the file out of "image", a copy of the whole
+//	disk, into "into", which has room for FileLength() bytes.  The
+//	file must have passed Claim.
+//----------------------------------------------------------------------
+
+void FileHeader::ReadImage(char *image, char *into) {
+    Extent *list = new Extent[NumSectors];
+    int *blocks = new int[NumSectors];
+    int i, n = 0;
+
+    (void)ImageExtents(image, list, blocks);
+    for (i = 0; i < numExtents && n < numBytes; i++) {
+        bcopy(&image[list[i].start * SectorSize], &into[n],
+              min(list[i].length * SectorSize, numBytes - n));
+        n += list[i].length * SectorSize;
     }
+    delete[] list;
+    delete[] blocks;
 }
 
 //----------------------------------------------------------------------
@@ -161,86 +450,21 @@ int FileHeader::ByteToSector(int offset) {
 
 int FileHeader::FileLength() { return numBytes; }
 
+//----------------------------------------------------------------------
+// FileHeader::Append
+// 	Grow the file by "fileSize" bytes, allocating new data sectors
+//	once the slack at the end of the last one is used up.  Return
+//	FALSE, leaving the file unchanged, if the disk is too full.
+//
+//	"freeMap" is the bit map of free disk sectors
+//	"fileSize" is the number of bytes to add
+//----------------------------------------------------------------------
+
 bool FileHeader::Append(BitMap *freeMap, int fileSize) {
-    printf("Append:\n");
-    int restFileSize =
-        SectorSize * getSecNum() -
-        numBytes;  // the size of the sector which haven't be used
-    if (restFileSize >= fileSize) {
-        numBytes = numBytes + fileSize;
-        printf(
-            "***********************the current sector is "
-            "enough*********************** \n");
-        return TRUE;
-    } else {
-        printf(
-            "***********************the current sector is not "
-            "enough*********************** \n");
-        int moreFileSize =
-            fileSize - restFileSize;  // the current sector is not enough, need
-                                      // to be extend
-        printf("in Append: moreFileSize: %d \n", moreFileSize);
-
-        if (freeMap->NumClear() < divRoundUp(moreFileSize, SectorSize)) {
-            return FALSE;
-        } else if (NumDirect + NumDirect2 <=
-                   getSecNum() +
-                       divRoundUp(moreFileSize,
-                                  SectorSize)) {  // the disk is enough but the
-                                                  // sum of the first inode and
-                                                  // th second is not enough
-            return FALSE;
-        }
-        int i = getSecNum();
-        numBytes = numBytes + fileSize;
-
-        // int AppendSector = divRoundUp(moreFileSize,SectorSize); //caculate
-        // the sector numbers need to be extend numSectors = numSectors +
-        // AppendSector;
-
-        int lastIndex = NumDirect - 1;
-
-        if (dataSectors[lastIndex] == -1) {
-            if (getSecNum() < lastIndex) {
-                printf(
-                    "***********************now the first inode is "
-                    "enough*********************** \n");
-                for (; i < getSecNum(); i++) {
-                    dataSectors[i] = freeMap->Find();
-                }
-            } else {  // extend the second inode
-                printf(
-                    "***********************now the first inode is not "
-                    "enough*********************** \n");
-                for (; i < lastIndex; i++) {
-                    dataSectors[i] =
-                        freeMap->Find();  // allocate the first inode
-                }
-                dataSectors[lastIndex] =
-                    freeMap->Find();  // set the sector of the second inode to
-                                      // the last of the first inode
-                int dataSector2[NumDirect2];
-                for (; i < getSecNum(); i++) {
-                    dataSector2[i - lastIndex] =
-                        freeMap->Find();  // allocate the second inode
-                }
-                synchDisk->WriteSector(dataSectors[lastIndex],
-                                       (char *)dataSector2);  // write back
-            }
-        } else {  // have use the second inode, but the extend files haven't
-                  // exceed the size of second inode
-            int dataSector2[NumDirect2];
-            synchDisk->ReadSector(
-                dataSectors[lastIndex],
-                (char *)dataSector2);  // find the second inode
-            for (; i < getSecNum(); i++) {
-                dataSector2[i - lastIndex] =
-                    freeMap->Find();  // allocate the second inode
-            }
-            synchDisk->WriteSector(dataSectors[lastIndex],
-                                   (char *)dataSector2);  // write back
-        }
-    }
+    int more = divRoundUp(numBytes + fileSize, SectorSize) - getSecNum();
+
+    if (!AddSectors(freeMap, more)) return FALSE;
+    numBytes += fileSize;
     return TRUE;
 }
 
@@ -257,83 +481,37 @@ void FileHeader::updateTime() {
 //	the data blocks pointed to by the file header.
 //----------------------------------------------------------------------
 
-void FileHeader::Print() {  // TODO HERE: NEED TO PRINT FULL FILE CONTENTS
-    printf("Print:\n");
+void FileHeader::Print() {
     int i, j, k;
-    int lastIndex = NumDirect - 1;
     char *data = new char[SectorSize];
 
-    if (dataSectors[lastIndex] == -1) {
-        if (lastUpdatedTime != 0) {
-            printf("FileHeader contents.  File size: %d,  Last Updated Time: ",
-                   numBytes);
-        } else {
-            printf("FileHeader contents.  File size: %d", numBytes);
-        }
-        if (lastUpdatedTime != 0) {
-            time_t ___time___ = lastUpdatedTime;
-            struct tm *ptm = localtime(&___time___);
-            // lastUpdatedTime is sec num from UTC 1970.1.1 00:00:00
-            // print time in readable format
-            printf("%d-%d-%d %d:%d:%d", ptm->tm_year + 1900, ptm->tm_mon + 1,
-                   ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
-        }
-        printf(",  File blocks:\n");
-        for (i = 0; i < getSecNum(); i++) printf("%d ", dataSectors[i]);
-        printf("\nFile contents:\n");
-        for (i = k = 0; i < getSecNum(); i++) {
-            synchDisk->ReadSector(dataSectors[i], data);
-            for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
-                if ('\040' <= data[j] && data[j] <= '\176')  // isprint(data[j])
-                    printf("%c", data[j]);
-                else
-                    printf("\\%x", (unsigned char)data[j]);
-            }
-            printf("\n");
-        }
-        delete[] data;
+    if (lastUpdatedTime != 0) {
+        printf("FileHeader contents.  File size: %d,  Last Updated Time: ",
+               numBytes);
+        time_t ___time___ = lastUpdatedTime;
+        struct tm *ptm = localtime(&___time___);
+        // lastUpdatedTime is sec num from UTC 1970.1.1 00:00:00
+        // print time in readable format
+        printf("%d-%d-%d %d:%d:%d", ptm->tm_year + 1900, ptm->tm_mon + 1,
+               ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
     } else {
-        int dataSectors2[NumDirect2];
-        synchDisk->ReadSector(dataSectors[lastIndex], (char *)dataSectors2);
-        if (lastUpdatedTime != 0) {
-            printf("FileHeader contents.  File size: %d,  Last Updated Time: ",
-                   numBytes);
-        } else {
-            printf("FileHeader contents.  File size: %d", numBytes);
-        }
-        if (lastUpdatedTime != 0) {
-            time_t ___time___ = lastUpdatedTime;
-            struct tm *ptm = localtime(&___time___);
-            // lastUpdatedTime is sec num from UTC 1970.1.1 00:00:00
-            // print time in readable format
-            printf("%d-%d-%d %d:%d:%d", ptm->tm_year + 1900, ptm->tm_mon + 1,
-                   ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
-        }
-        printf(",  File blocks:\n");
-        for (i = 0; i < lastIndex; i++) printf("%d ", dataSectors[i]);
-        for (; i < getSecNum(); i++) printf("%d ", dataSectors2[i - lastIndex]);
-        printf("\nFile contents:\n");
-        for (i = k = 0; i < lastIndex; i++) {
-            synchDisk->ReadSector(dataSectors[i], data);
-            for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
-                if ('\040' <= data[j] && data[j] <= '\176')
-                    printf("%c", data[j]);
-                else
-                    printf("\\%x", (unsigned char)data[j]);
-            }
-            printf("\n");
-        }
-        for (; i < getSecNum(); i++) {
-            synchDisk->ReadSector(dataSectors2[i - lastIndex], data);
-            for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
-                if ('\040' <= data[j] && data[j] <= '\176')
-                    printf("%c", data[j]);
-                else
-                    printf("\\%x", (unsigned char)data[j]);
-            }
-            printf("\n");
+        printf("FileHeader contents.  File size: %d", numBytes);
+    }
+    printf(",  File extents:\n");
+    for (i = 0; i < numExtents; i++) {
+        Extent extent = GetExtent(i);
+        printf("%d-%d ", extent.start, extent.start + extent.length - 1);
+    }
+    printf("\nFile contents:\n");
+    for (i = k = 0; i < getSecNum(); i++) {
+        journal->Read(ByteToSector(i * SectorSize), data);
+        for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
+            if ('\040' <= data[j] && data[j] <= '\176')  // isprint(data[j])
+                printf("%c", data[j]);
+            else
+                printf("\\%x", (unsigned char)data[j]);
         }
-
-        delete[] data;
+        printf("\n");
     }
+    delete[] data;
 }
@@ -17,20 +17,39 @@
 #include "bitmap.h"
 #include "disk.h"
 
-#define NumDirect (int)((SectorSize - 2 * sizeof(int)) / sizeof(int))
-#define NumDirect2 (int)(SectorSize / sizeof(int))
-#define MaxFileSize ((NumDirect + NumDirect2) * SectorSize)
+// A file's data lives in a list of extents, each a run of consecutive
+// sectors.  The first NumExtents of them are kept in the file header;
+// the rest spill into a chain of extent blocks, one sector apiece.
+// A file can therefore grow until the disk is full.
+
+#define NumExtents (int)((SectorSize - 4 * sizeof(int)) / (2 * sizeof(int)))
+#define ExtentsPerSector (int)((SectorSize - 2 * sizeof(int)) / (2 * sizeof(int)))
+#define MaxFileSize (NumSectors * SectorSize)
+
+class Extent {
+   public:
+    int start;   // First sector of the run
+    int length;  // Number of sectors in the run
+};
+
+class ExtentBlock {
+   public:
+    int next;                          // Next extent block, or -1
+    int unused;                        // Pads the block to a full sector
+    Extent extents[ExtentsPerSector];  // Further extents of the file
+};
 
 // The following class defines the Nachos "file header" (in UNIX terms,
 // the "i-node"), describing where on disk to find all of the data in the file.
-// The file header is organized as a simple table of pointers to
-// data blocks.
+// The file header is organized as a table of extents: the i-th sector of
+// the file is found by walking the extents until their lengths add up
+// past i.
 //
 // The file header data structure can be stored in memory or on disk.
 // When it is on disk, it is stored in a single sector -- this means
 // that we assume the size of this data structure to be the same
-// as one disk sector.  Without indirect addressing, this
-// limits the maximum file length to just under 4K bytes.
+// as one disk sector.  Extents that do not fit in the header are
+// stored in extent blocks, chained from "moreExtents".
 //
 // There is no constructor; rather the file header can be initialized
 // by allocating blocks for the file (if it is a new file), or by
@@ -58,6 +77,12 @@ class FileHeader {
     int FileLength();  // Return the length of the file
                        // in bytes
 
+    int Claim(char *image, int *owner, int self, int *numRuns);
+    // Note the sectors of the file as
+    //  belonging to it, for a disk check
+    void ReadImage(char *image, char *into);  // Copy the file out of
+                                               //  a copy of the disk
+
     void Print();  // Print the contents of the file.
 
     int getSecNum() { return divRoundUp(numBytes, SectorSize); }
@@ -67,14 +92,25 @@ class FileHeader {
     void setTime(int given_time) { lastUpdatedTime = given_time; }
 
    private:
-    int numBytes;  // Number of bytes in the file
-    // int numSectors;
+    bool AddSectors(BitMap *freeMap, int count);  // Grow the file by
+                                                   //  "count" sectors
+    Extent GetExtent(int i);                       // Read/write the i-th
+    void PutExtent(int i, Extent extent);          //  extent of the file
+    int ExtentBlockSector(int n);                  // Sector of the n-th
+                                                   //  extent block
+    int ImageExtents(char *image, Extent *list, int *blocks);
+    // The extents, found in a copy
+    //  of the disk
+
+    int numBytes;                // Number of bytes in the file
     int lastUpdatedTime;         // Last updated time. This time format is
                                  // the number of seconds since 00:00:00
                                  // January 1, 1970, Coordinated Universal
                                  // Time (UTC), minus leap seconds.
-    int dataSectors[NumDirect];  // Disk sector numbers for each data
-                                 // block in the file
+    int numExtents;              // Number of extents in the file
+    int moreExtents;             // First extent block, or -1 if all the
+                                 // extents fit in the header
+    Extent extents[NumExtents];  // The first extents of the file
 };
 
 #endif  // FILEHDR_H
@@ -7,7 +7,8 @@
 //		(the size of the file header data structure is arranged
 //		to be precisely the size of 1 disk sector)
 //	   A number of data blocks
-//	   An entry in the file system directory
+//	   An entry in a directory; directories are files themselves,
+//	     starting from the root
 //
 // 	The file system consists of several data structures:
 //	   A bitmap of free disk sectors (cf. bitmap.h)
@@ -21,23 +22,31 @@
 //	The file system assumes that the bitmap and directory files are
 //	kept "open" continuously while Nachos is running.
 //
-//	For those operations (such as Create, Remove) that modify the
-//	directory and/or bitmap, if the operation succeeds, the changes
-//	are written immediately back to disk (the two files are kept
-//	open during all this time).  If the operation fails, and we have
-//	modified part of the directory and/or bitmap, we simply discard
-//	the changed version, without writing it back to disk.
+//	The bitmap and the root directory are also kept in memory, and
+//	operations (such as Create, Remove) change those copies.  The
+//	changes are written back by Sync, which happens on request, at
+//	shutdown, once the oldest unwritten change is SyncInterval
+//	ticks old, and once the journal is half full.  A subdirectory is
+//	read from disk when it is needed, and written back as soon as it
+//	changes.  If an operation fails part way, it undoes whatever it
+//	changed in memory.
+//
+//	File headers, directories and the bitmap are written through the
+//	journal (cf. journal.h): Sync commits everything changed since the
+//	last Sync as one batch, so after a crash the disk holds the file
+//	system as it was at some Sync.  Sectors freed by Remove are not
+//	handed out again until the batch freeing them is committed, so
+//	that new data never overwrites sectors the disk still says are
+//	in use; and their uncommitted changes are dropped from the batch
+//	(Journal::Forget), so that replaying it never writes old file
+//	system data over what a file has since put there.
 //
 // 	Our implementation at this point has the following restrictions:
 //
 //	   there is no synchronization for concurrent accesses
-//	   files have a fixed size, set when the file is created
-//	   files cannot be bigger than about 3KB in size
-//	   there is no hierarchical directory structure, and only a limited
-//	     number of files can be added to the system
-//	   there is no attempt to make the system robust to failures
-//	    (if Nachos exits in the middle of an operation that modifies
-//	    the file system, it may corrupt the disk)
+//	   file names are at most FileNameMaxLen characters long
+//	   changes made since the last Sync are lost if Nachos exits
+//	    without one (though the disk is left consistent)
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -50,6 +59,9 @@
 #include "directory.h"
 #include "filehdr.h"
 #include "filesys.h"
+#include "journal.h"
+#include "synch.h"
+#include "system.h"
 
 // Sectors containing the file headers for the bitmap of free sectors,
 // and the directory of files.  These file headers are placed in well-known 
@@ -57,11 +69,9 @@
 #define FreeMapSector 		0
 #define DirectorySector 	1
 
-// Initial file sizes for the bitmap and directory; until the file system
-// supports extensible files, the directory size sets the maximum number 
-// of files that can be loaded onto the disk.
+// Initial file sizes for the bitmap and directory; directories grow
+// as files are added to them.
 #define FreeMapFileSize 	(NumSectors / BitsInByte)
-#define NumDirEntries 		10
 #define DirectoryFileSize 	(sizeof(DirectoryEntry) * NumDirEntries)
 
 //----------------------------------------------------------------------
@@ -80,18 +90,26 @@
 FileSystem::FileSystem(bool format)
 { 
     DEBUG('f', "Initializing the file system.\n");
+    journal = new Journal(format);	// replays the journal, if need be
+    dentries = new DentryCache;
+    lock = new Lock("file system");
+    freeMap = new BitMap(NumSectors);
+    root = new Directory(NumDirEntries);
+    freeMapDirty = FALSE;
+    dirtySince = -1;
+    sectorsFreed = FALSE;
     if (format) {
-        BitMap *freeMap = new BitMap(NumSectors);
-        Directory *directory = new Directory(NumDirEntries);
 	FileHeader *mapHdr = new FileHeader;
 	FileHeader *dirHdr = new FileHeader;
 
         DEBUG('f', "Formatting the file system.\n");
 
-    // First, allocate space for FileHeaders for the directory and bitmap
-    // (make sure no one else grabs these!)
+    // First, allocate space for FileHeaders for the directory and bitmap,
+    // and the journal (make sure no one else grabs these!)
 	freeMap->Mark(FreeMapSector);	    
 	freeMap->Mark(DirectorySector);
+	for (int i = JournalStart; i < JournalStart + JournalSectors; i++)
+	    freeMap->Mark(i);
 
     // Second, allocate space for the data blocks containing the contents
     // of the directory and bitmap files.  There better be enough space!
@@ -114,6 +132,8 @@ FileSystem::FileSystem(bool format)
 
         freeMapFile = new OpenFile(FreeMapSector);
         directoryFile = new OpenFile(DirectorySector);
+	freeMapFile->LogWrites();
+	directoryFile->LogWrites();
      
     // Once we have the files "open", we can write the initial version
     // of each file back to disk.  The directory at this point is completely
@@ -123,14 +143,13 @@ FileSystem::FileSystem(bool format)
 
         DEBUG('f', "Writing bitmap and directory back to disk.\n");
 	freeMap->WriteBack(freeMapFile);	 // flush changes to disk
-	directory->WriteBack(directoryFile);
+	root->WriteBack(directoryFile);
+	journal->Commit();
 
 	if (DebugIsEnabled('f')) {
 	    freeMap->Print();
-	    directory->Print();
+	    root->Print();
         }
-        delete freeMap; 
-	delete directory; 
 	delete mapHdr; 
 	delete dirHdr;
 
@@ -139,78 +158,353 @@ FileSystem::FileSystem(bool format)
     // the bitmap and directory; these are left open while Nachos is running
         freeMapFile = new OpenFile(FreeMapSector);
         directoryFile = new OpenFile(DirectorySector);
+	freeMapFile->LogWrites();
+	directoryFile->LogWrites();
+	freeMap->FetchFrom(freeMapFile);
+	root->FetchFrom(directoryFile);
+    }
+}
+
+//----------------------------------------------------------------------
+// FileSystem::~FileSystem
+// 	Write back any changes still held in memory, and close the
+//	bitmap and directory files, and the journal.
+//----------------------------------------------------------------------
+
+FileSystem::~FileSystem()
+{
+    Sync();
+    delete journal;
+    journal = NULL;
+    delete freeMapFile;
+    delete directoryFile;
+    delete freeMap;
+    delete root;
+    delete dentries;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Changed
+// 	Note that an operation has left the in-memory free map (and
+//	perhaps the root directory) not matching the disk.  If the oldest
+//	such change has waited SyncInterval ticks, or the journal is
+//	filling up, write everything back now.
+//
+//	This is called once the operation is done with everything else,
+//	so that the whole of it goes into the same batch.
+//----------------------------------------------------------------------
+
+void
+FileSystem::Changed()
+{
+    freeMapDirty = TRUE;
+    if (dirtySince == -1)
+	dirtySince = stats->totalTicks;
+    if (stats->totalTicks - dirtySince >= SyncInterval ||
+	journal->NumPending() >= JournalCapacity / 2)
+	Flush();
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Sync
+// FileSystem::Flush
+// 	Write the free map and the root directory back, if they have
+//	changed, and commit them to disk along with everything else
+//	written through the journal since the last time.  Flush expects
+//	the caller to hold the lock.
+//
+//	Sync also waits for the journal to be checkpointed, so the next
+//	mount has nothing to replay; it is called before shutting down.
+//----------------------------------------------------------------------
+
+void
+FileSystem::Sync()
+{
+    lock->Acquire();
+    Flush();
+    journal->Checkpoint();
+    lock->Release();
+}
+
+void
+FileSystem::Flush()
+{
+    if (freeMapDirty) {
+	DEBUG('f', "Writing back the free map and root directory.\n");
+	freeMap->WriteBack(freeMapFile);
+	freeMapDirty = FALSE;
+    }
+    root->WriteBack(directoryFile);	// only the entries changed
+    journal->Commit();
+    dirtySince = -1;
+    sectorsFreed = FALSE;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Extend
+// 	Grow the file whose header is "hdr" by "numBytes", allocating
+//	sectors from the in-memory free map.  The caller writes the file
+//	header back.  Return FALSE if the disk is too full.
+//----------------------------------------------------------------------
+
+bool
+FileSystem::Extend(FileHeader *hdr, int numBytes)
+{
+    int before;
+    bool success;
+
+    lock->Acquire();
+    if (sectorsFreed)
+	Flush();			// before any of them are reused
+    before = freeMap->NumClear();
+    success = hdr->Append(freeMap, numBytes);
+    if (freeMap->NumClear() != before)
+	Changed();
+    lock->Release();
+    return success;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::FetchDir
+// 	Return the directory whose header is at "sector", and the open
+//	file holding it in "file".  The root directory is kept in memory
+//	and is handed out itself, along with its file, which is kept open
+//	so that the root's file header is only ever changed in one place.
+//	Any other directory is read from disk.
+//----------------------------------------------------------------------
+
+Directory *
+FileSystem::FetchDir(int sector, OpenFile **file)
+{
+    Directory *directory;
+
+    if (sector == DirectorySector) {
+	*file = directoryFile;
+	return root;
+    }
+    *file = new OpenFile(sector);
+    (*file)->LogWrites();
+    directory = new Directory(NumDirEntries);
+    directory->FetchFrom(*file);
+    return directory;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::ReleaseDir
+// 	Done with a directory from FetchDir.  If it was "changed", a
+//	subdirectory is written back right away; changes to the root wait
+//	for the next Sync (the caller notes them with Changed).
+//----------------------------------------------------------------------
+
+void
+FileSystem::ReleaseDir(Directory *dir, OpenFile *file, bool changed)
+{
+    if (dir == root)
+	return;
+    if (changed)
+	dir->WriteBack(file);
+    delete dir;
+    delete file;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Lookup
+// 	Return the sector of the file header for "name" in the directory
+//	whose header is at "dirSector", or -1 if there is no such file.
+//	Also set "isDir" to whether the file is a directory.
+//
+//	Recent lookups are cached, so that opening a file by its path
+//	need not read each directory along the way from disk.
+//----------------------------------------------------------------------
+
+int
+FileSystem::Lookup(int dirSector, char *name, bool *isDir)
+{
+    int sector = dentries->Lookup(dirSector, name, isDir);
+    OpenFile *dirFile;
+    Directory *directory;
+
+    if (sector != -1)
+	return sector;
+    directory = FetchDir(dirSector, &dirFile);
+    sector = directory->Find(name);
+    if (sector != -1) {
+	*isDir = directory->IsDir(name);
+	dentries->Enter(dirSector, name, sector, *isDir);
+    }
+    ReleaseDir(directory, dirFile, FALSE);
+    return sector;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Walk
+// 	Resolve a path such as "a/b/c" (a leading '/' is allowed; names
+//	are relative to the root either way).  Return the sector of the
+//	header of the directory that should hold the last component, and
+//	copy that component into "name".  Return -1 if some directory on
+//	the way does not exist, or if the path is empty.
+//
+//	Each component is cut to FileNameMaxLen characters, the same way
+//	the directory compares names.
+//
+//	"path" -- the path to resolve
+//	"name" -- space for FileNameMaxLen + 1 characters
+//----------------------------------------------------------------------
+
+int
+FileSystem::Walk(char *path, char *name)
+{
+    int dirSector = DirectorySector;
+    bool isDir;
+    int len;
+
+    while (*path == '/')
+	path++;
+    for (;;) {
+	for (len = 0; path[len] != '\0' && path[len] != '/'; len++)
+	    ;
+	if (len == 0)
+	    return -1;			// empty name
+	strncpy(name, path, min(len, FileNameMaxLen));
+	name[min(len, FileNameMaxLen)] = '\0';
+	path += len;
+	while (*path == '/')
+	    path++;
+	if (*path == '\0')
+	    return dirSector;		// "name" is the last component
+	dirSector = Lookup(dirSector, name, &isDir);
+	if (dirSector == -1 || !isDir)
+	    return -1;			// no such directory
     }
 }
 
 //----------------------------------------------------------------------
 // FileSystem::Create
 // 	Create a file in the Nachos file system (similar to UNIX create).
-//	Since we can't increase the size of files dynamically, we have
-//	to give Create the initial size of the file.
+//	We give Create the initial size of the file; it can be grown
+//	later by appending to it.
 //
 //	The steps to create a file are:
 //	  Make sure the file doesn't already exist
 //        Allocate a sector for the file header
 // 	  Allocate space on disk for the data blocks for the file
-//	  Add the name to the directory
+//	  Add the name to the directory, growing the directory file
+//	    if its table had to be enlarged
 //	  Store the new file header on disk 
 //	  Flush the changes to the bitmap and the directory back to disk
 //
 //	Return TRUE if everything goes ok, otherwise, return FALSE.
 //
 // 	Create fails if:
+//		a directory in the path does not exist
 //   		file is already in directory
 //	 	no free space for file header
-//	 	no free entry for file in directory
 //	 	no free space for data blocks for the file 
+//	 	no free space to grow the directory
 //
 // 	Note that this implementation assumes there is no concurrent access
 //	to the file system!
 //
-//	"name" -- name of file to be created
+//	"name" -- path of file to be created
 //	"initialSize" -- size of file to be created
 //----------------------------------------------------------------------
 
 bool
 FileSystem::Create(char *name, int initialSize)
 {
-    Directory *directory;
-    BitMap *freeMap;
-    FileHeader *hdr;
-    int sector;
     bool success;
 
     DEBUG('f', "Creating file %s, size %d\n", name, initialSize);
+    lock->Acquire();
+    success = Make(name, initialSize, FALSE);
+    lock->Release();
+    return success;
+}
 
-    directory = new Directory(NumDirEntries);
-    directory->FetchFrom(directoryFile);
-
-    if (directory->Find(name) != -1)
-      success = FALSE;			// file is already in directory
-    else {	
-        freeMap = new BitMap(NumSectors);
-        freeMap->FetchFrom(freeMapFile);
-        sector = freeMap->Find();	// find a sector to hold the file header
-    	if (sector == -1) 		
-            success = FALSE;		// no free block for file header 
-        else if (!directory->Add(name, sector))
-            success = FALSE;	// no space in directory
-	else {
-    	    hdr = new FileHeader;
-	    if (!hdr->Allocate(freeMap, initialSize))
-            	success = FALSE;	// no space on disk for data
-	    else {	
-	    	success = TRUE;
-		// everthing worked, flush all changes back to disk
-    	    	hdr->WriteBack(sector); 		
-    	    	directory->WriteBack(directoryFile);
-    	    	freeMap->WriteBack(freeMapFile);
-	    }
-            delete hdr;
+//----------------------------------------------------------------------
+// FileSystem::Mkdir
+// 	Create an empty directory, in the same way as Create makes a file.
+//
+//	"name" -- path of the directory to be created
+//----------------------------------------------------------------------
+
+bool
+FileSystem::Mkdir(char *name)
+{
+    bool success;
+
+    DEBUG('f', "Creating directory %s\n", name);
+    lock->Acquire();
+    success = Make(name, DirectoryFileSize, TRUE);
+    lock->Release();
+    return success;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Make
+// 	Do the work of Create and Mkdir, with the lock held.  A new
+//	directory file is initialized with an empty table.
+//
+//	Everything that can fail is done before the name goes into the
+//	directory; on failure the space already taken is handed back, so
+//	the in-memory free map and root directory are left as they were.
+//----------------------------------------------------------------------
+
+bool
+FileSystem::Make(char *path, int initialSize, bool isDir)
+{
+    Directory *directory;
+    OpenFile *dirFile;
+    FileHeader *hdr;
+    char name[FileNameMaxLen + 1];
+    int dirSector, sector;
+    bool success = FALSE;
+
+    dirSector = Walk(path, name);
+    if (dirSector == -1)
+	return FALSE;			// no such directory
+    directory = FetchDir(dirSector, &dirFile);
+
+    if (directory->Find(name) != -1) {
+	ReleaseDir(directory, dirFile, FALSE);
+	return FALSE;			// file is already in directory
+    }
+    if (sectorsFreed)
+	Flush();			// before any of them are reused
+    sector = freeMap->Find();		// find a sector to hold the file header
+    if (sector == -1) {
+	ReleaseDir(directory, dirFile, FALSE);
+	return FALSE;			// no free block for file header 
+    }
+    hdr = new FileHeader;
+    if (!hdr->Allocate(freeMap, initialSize))
+	freeMap->Clear(sector);		// no space on disk for data
+    else if (directory->IsFull() &&
+	     !dirFile->Grow(freeMap, directory->FileSize())) {
+	hdr->Deallocate(freeMap);	// no space to grow the directory
+	freeMap->Clear(sector);
+    } else {
+	success = TRUE;
+	if (directory->IsFull())
+	    directory->Grow();
+	directory->Add(name, sector, isDir);
+	hdr->WriteBack(sector); 		
+	dentries->Enter(dirSector, name, sector, isDir);
+	if (isDir) {
+	    OpenFile *file = new OpenFile(sector);
+	    Directory *empty = new Directory(NumDirEntries);
+
+	    file->LogWrites();
+	    empty->WriteBack(file);
+	    delete empty;
+	    delete file;
 	}
-        delete freeMap;
     }
-    delete directory;
+    delete hdr;
+    ReleaseDir(directory, dirFile, success);
+    if (success)
+	Changed();
     return success;
 }
 
@@ -218,25 +512,29 @@ FileSystem::Create(char *name, int initialSize)
 // FileSystem::Open
 // 	Open a file for reading and writing.  
 //	To open a file:
-//	  Find the location of the file's header, using the directory 
+//	  Find the location of the file's header, using the directories
+//	    along its path (or the lookup cache)
 //	  Bring the header into memory
 //
-//	"name" -- the text name of the file to be opened
+//	"name" -- the path of the file to be opened
 //----------------------------------------------------------------------
 
 OpenFile *
 FileSystem::Open(char *name)
 { 
-    Directory *directory = new Directory(NumDirEntries);
+    char last[FileNameMaxLen + 1];
     OpenFile *openFile = NULL;
-    int sector;
+    int dirSector, sector = -1;
+    bool isDir;
 
     DEBUG('f', "Opening file %s\n", name);
-    directory->FetchFrom(directoryFile);
-    sector = directory->Find(name); 
+    lock->Acquire();
+    dirSector = Walk(name, last);
+    if (dirSector != -1)
+	sector = Lookup(dirSector, last, &isDir);
+    lock->Release();
     if (sector >= 0) 		
 	openFile = new OpenFile(sector);	// name was found in directory 
-    delete directory;
     return openFile;				// return NULL if not found
 }
 
@@ -248,42 +546,62 @@ FileSystem::Open(char *name)
 //	    Delete the space for its data blocks
 //	    Write changes to directory, bitmap back to disk
 //
+//	A directory can only be removed once it is empty.
+//
 //	Return TRUE if the file was deleted, FALSE if the file wasn't
-//	in the file system.
+//	in the file system, or is a directory with files in it.
 //
-//	"name" -- the text name of the file to be removed
+//	"name" -- the path of the file to be removed
 //----------------------------------------------------------------------
 
 bool
 FileSystem::Remove(char *name)
 { 
     Directory *directory;
-    BitMap *freeMap;
+    OpenFile *dirFile;
     FileHeader *fileHdr;
-    int sector;
+    char last[FileNameMaxLen + 1];
+    int dirSector, sector;
     
-    directory = new Directory(NumDirEntries);
-    directory->FetchFrom(directoryFile);
-    sector = directory->Find(name);
+    lock->Acquire();
+    dirSector = Walk(name, last);
+    if (dirSector == -1) {
+	lock->Release();
+	return FALSE;			// no such directory
+    }
+    directory = FetchDir(dirSector, &dirFile);
+    sector = directory->Find(last);
     if (sector == -1) {
-       delete directory;
+       ReleaseDir(directory, dirFile, FALSE);
+       lock->Release();
        return FALSE;			 // file not found 
     }
+    if (directory->IsDir(last)) {
+	OpenFile *file;
+	Directory *sub = FetchDir(sector, &file);
+	bool empty = sub->IsEmpty();
+
+	ReleaseDir(sub, file, FALSE);
+	if (!empty) {
+	    ReleaseDir(directory, dirFile, FALSE);
+	    lock->Release();
+	    return FALSE;		// directory still has files in it
+	}
+    }
     fileHdr = new FileHeader;
     fileHdr->FetchFrom(sector);
 
-    freeMap = new BitMap(NumSectors);
-    freeMap->FetchFrom(freeMapFile);
-
     fileHdr->Deallocate(freeMap);  		// remove data blocks
     freeMap->Clear(sector);			// remove header block
-    directory->Remove(name);
+    journal->Forget(sector);
+    directory->Remove(last);
+    dentries->Forget(dirSector, last);
+    sectorsFreed = TRUE;
 
-    freeMap->WriteBack(freeMapFile);		// flush to disk
-    directory->WriteBack(directoryFile);        // flush to disk
     delete fileHdr;
-    delete directory;
-    delete freeMap;
+    ReleaseDir(directory, dirFile, TRUE);
+    Changed();
+    lock->Release();
     return TRUE;
 } 
 
@@ -295,11 +613,9 @@ FileSystem::Remove(char *name)
 void
 FileSystem::List()
 {
-    Directory *directory = new Directory(NumDirEntries);
-
-    directory->FetchFrom(directoryFile);
-    directory->List();
-    delete directory;
+    lock->Acquire();
+    root->List();
+    lock->Release();
 }
 
 //----------------------------------------------------------------------
@@ -309,22 +625,16 @@ FileSystem::List()
 void
 FileSystem::DiskMessage() {
     // printf("Bitmap DiskMessage: \n");
-    FileHeader *bitHdr = new FileHeader;
-    FileHeader *dirHdr = new FileHeader;
-    BitMap *freeMap = new BitMap(NumSectors);
-    Directory *directory = new Directory(NumDirEntries);
-
+    lock->Acquire();
     printf("Disk size: %d sectors, %d  bytes. \n", NumSectors, NumSectors*128);
 
-    freeMap->FetchFrom(freeMapFile);
     int usedBits = freeMap->getUsedBitsNumber();
 
     printf("Used: %d  sectors, %d  bytes.\n",usedBits,usedBits*128);
     printf("Free: %d  sectors, %d  bytes.\n",NumSectors-usedBits,(NumSectors-usedBits)*128);
 
-    directory->FetchFrom(directoryFile);
-    directory->DiskMessage();
-    delete directory;
+    root->DiskMessage();
+    lock->Release();
    // printf("Disk size: %d sectors, %d bytes.",getSecNum(),numBytes);
     //printf("Used:  sectors, %d bytes. \n", numBits);
 }
@@ -345,9 +655,9 @@ FileSystem::Print()
 {
     FileHeader *bitHdr = new FileHeader;
     FileHeader *dirHdr = new FileHeader;
-    BitMap *freeMap = new BitMap(NumSectors);
-    Directory *directory = new Directory(NumDirEntries);
 
+    lock->Acquire();
+    Flush();				// so the files on disk are current
     printf("Bit map file header:\n");
     bitHdr->FetchFrom(FreeMapSector);
     bitHdr->Print();
@@ -356,14 +666,297 @@ FileSystem::Print()
     dirHdr->FetchFrom(DirectorySector);
     dirHdr->Print();
 
-    freeMap->FetchFrom(freeMapFile);
     freeMap->Print();
-
-    directory->FetchFrom(directoryFile);
-    directory->Print();
+    root->Print();
+    lock->Release();
 
     delete bitHdr;
     delete dirHdr;
-    delete freeMap;
-    delete directory;
+}
+
+//----------------------------------------------------------------------
+// DiskCheck
+// 	What a check of the disk (cf. FileSystem::Check) keeps track of:
+//	a copy of the whole disk, which file each sector belongs to (by
+//	the sector of its header), the directory entries found to be bad,
+//	and some figures about fragmentation.
+//----------------------------------------------------------------------
+
+class DiskCheck {
+  public:
+    DiskCheck();
+    ~DiskCheck();
+
+    bool CheckFile(int sector, const char *path, FileHeader *hdr);
+					// Claim a file's sectors for it
+    void CheckDir(int sector, const char *path, FileHeader *hdr);
+					// Check the files in a directory
+    void Name(int sector, const char *path);
+					// Remember what owns "sector"
+
+    char *image;			// The whole disk
+    int *owner;				// Header of the file each sector
+					//   belongs to, or -1
+    char **names;			// Path of the file with each header
+    int problems;			// Problems found so far
+    int numBad, maxBad;			// Directory entries to remove:
+    int *badDir;			//   the directory, and the name
+    char (*badName)[FileNameMaxLen + 1];//   and header of the entry
+    int *badSector;
+    int numFiles, numDirs;		// Files and directories found
+    int numRuns, numFragmented;		// Their extents, and how many
+					//   of them have more than one
+    int slack;				// Bytes unused in their last sectors
+};
+
+DiskCheck::DiskCheck()
+{
+    image = new char[NumSectors * SectorSize];
+    owner = new int[NumSectors];
+    names = new char *[NumSectors];
+    maxBad = NumSectors * (SectorSize / sizeof(DirectoryEntry));
+					// every entry on the disk could be bad
+    badDir = new int[maxBad];
+    badName = new char[maxBad][FileNameMaxLen + 1];
+    badSector = new int[maxBad];
+    for (int i = 0; i < NumSectors; i++) {
+	owner[i] = -1;
+	names[i] = NULL;
+    }
+    problems = numBad = 0;
+    numFiles = numDirs = numRuns = numFragmented = slack = 0;
+}
+
+DiskCheck::~DiskCheck()
+{
+    for (int i = 0; i < NumSectors; i++)
+	delete [] names[i];
+    delete [] image;
+    delete [] owner;
+    delete [] names;
+    delete [] badDir;
+    delete [] badName;
+    delete [] badSector;
+}
+
+void
+DiskCheck::Name(int sector, const char *path)
+{
+    delete [] names[sector];
+    names[sector] = new char[strlen(path) + 1];
+    strcpy(names[sector], path);
+}
+
+//----------------------------------------------------------------------
+// DiskCheck::CheckFile
+// 	Check the file whose header is at "sector", and claim its header
+//	and the rest of its sectors for it.  On success, copy the header
+//	into "hdr" and return TRUE; otherwise say what is wrong, and
+//	claim nothing.
+//----------------------------------------------------------------------
+
+bool
+DiskCheck::CheckFile(int sector, const char *path, FileHeader *hdr)
+{
+    int bad, runs;
+
+    if (sector < 0 || sector >= NumSectors) {
+	printf("%s: header sector %d is not on the disk\n", path, sector);
+	problems++;
+	return FALSE;
+    }
+    if (owner[sector] != -1) {
+	printf("%s: header sector %d is also used by %s\n", path, sector,
+	       names[owner[sector]]);
+	problems++;
+	return FALSE;
+    }
+    bcopy(&image[sector * SectorSize], (char *)hdr, sizeof(FileHeader));
+    owner[sector] = sector;
+    Name(sector, path);
+    bad = hdr->Claim(image, owner, sector, &runs);
+    if (bad != -1) {
+	if (bad == -2)
+	    printf("%s: file header is damaged\n", path);
+	else if (bad < 0 || bad >= NumSectors)
+	    printf("%s: sector %d is not on the disk\n", path, bad);
+	else
+	    printf("%s: sector %d is also used by %s\n", path, bad,
+		   names[owner[bad]]);
+	owner[sector] = -1;
+	problems++;
+	return FALSE;
+    }
+    numRuns += runs;
+    if (runs > 1)
+	numFragmented++;
+    slack += hdr->getSecNum() * SectorSize - hdr->FileLength();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// DiskCheck::CheckDir
+// 	Check every file in the directory whose header, already checked,
+//	is "hdr" at "sector", and the directories below it.  Entries for
+//	files that fail the check are noted, so they can be removed.
+//----------------------------------------------------------------------
+
+void
+DiskCheck::CheckDir(int sector, const char *path, FileHeader *hdr)
+{
+    int size = hdr->FileLength() / sizeof(DirectoryEntry);
+    DirectoryEntry *table = new DirectoryEntry[size + 1];
+    char *child = new char[strlen(path) + FileNameMaxLen + 2];
+    FileHeader *childHdr = new FileHeader;
+
+    hdr->ReadImage(image, (char *)table);
+    for (int i = 0; i < size; i++) {
+	if (!table[i].inUse)
+	    continue;
+	table[i].name[FileNameMaxLen] = '\0';
+	sprintf(child, "%s/%s", path, table[i].name);
+	if (!CheckFile(table[i].sector, child, childHdr)) {
+	    if (numBad == maxBad)
+		continue;		// full; cannot happen, since no
+					//   sector is read as a directory twice
+	    badDir[numBad] = sector;
+	    strcpy(badName[numBad], table[i].name);
+	    badSector[numBad++] = table[i].sector;
+	} else if (table[i].isDir) {
+	    numDirs++;
+	    CheckDir(table[i].sector, child, childHdr);
+	} else {
+	    numFiles++;
+	}
+    }
+    delete childHdr;
+    delete [] child;
+    delete [] table;
+}
+
+//----------------------------------------------------------------------
+// FileSystem::Check
+// 	Check that the file system on disk is consistent, and print what
+//	is wrong with it, along with figures about fragmentation:
+//	   every file header, directory entry and extent must make sense
+//	   no sector may belong to two files (or to a file and the
+//	     journal, or twice to the same file)
+//	   the free map must mark exactly the sectors that belong to
+//	     something: a sector marked free but in use is about to be
+//	     handed out twice; one marked in use that nothing has is lost
+//
+//	The whole disk is read in one request, and the rest of the check
+//	works on that copy, so it takes little longer than reading the
+//	disk once.
+//
+//	If "repair", directory entries for broken files are removed (so
+//	those files are lost), and the free map is rebuilt from what the
+//	remaining files use.  Return the number of problems found.
+//----------------------------------------------------------------------
+
+int
+FileSystem::Check(bool repair)
+{
+    DiskCheck *check = new DiskCheck;
+    FileHeader *hdr = new FileHeader;
+    int *sectors = new int[NumSectors];
+    JournalHeader *jh;
+    OpenFile *dirFile;
+    Directory *directory;
+    int i, first, numFree, numHoles, largest, problems;
+
+    lock->Acquire();
+    Flush();				// so that the disk is up to date
+    for (i = 0; i < NumSectors; i++)
+	sectors[i] = i;
+    journal->ReadSectors(NumSectors, sectors, check->image);
+    delete [] sectors;
+
+    jh = (JournalHeader *)&check->image[JournalStart * SectorSize];
+    if (jh->magic != JournalMagic) {
+	printf("The journal header is missing\n");
+	check->problems++;
+    }
+    check->Name(JournalStart, "the journal");
+    for (i = JournalStart; i < JournalStart + JournalSectors; i++)
+	check->owner[i] = JournalStart;
+    if (check->CheckFile(FreeMapSector, "the free map", hdr) &&
+	  hdr->FileLength() < FreeMapFileSize) {
+	printf("the free map: only %d bytes long\n", hdr->FileLength());
+	check->problems++;
+    }
+    if (!check->CheckFile(DirectorySector, "/", hdr)) {
+	printf("The root directory is lost; nothing more can be checked\n");
+	lock->Release();
+	problems = check->problems + 1;
+	delete hdr;
+	delete check;
+	return problems;
+    }
+    check->numDirs++;
+    check->CheckDir(DirectorySector, "", hdr);
+
+    // compare what the files use with the free map
+    numFree = numHoles = largest = 0;
+    for (i = 0; i < NumSectors; i = first) {
+	first = i + 1;
+	if (check->owner[i] != -1) {
+	    if (!freeMap->Test(i)) {
+		printf("Sector %d: used by %s, but marked free\n", i,
+		       check->names[check->owner[i]]);
+		check->problems++;
+	    }
+	    continue;
+	}
+	while (first < NumSectors && check->owner[first] == -1)
+	    first++;
+	numFree += first - i;
+	numHoles++;
+	largest = max(largest, first - i);
+	for (int j = i; j < first; j++)
+	    if (freeMap->Test(j)) {
+		int k = j;
+
+		while (k + 1 < first && freeMap->Test(k + 1))
+		    k++;
+		printf("Sectors %d-%d: marked in use, but not used\n", j, k);
+		check->problems++;
+		j = k;
+	    }
+    }
+
+    printf("%d files and %d directories, in %d extents; "
+	   "%d of them in more than one.\n", check->numFiles,
+	   check->numDirs, check->numRuns, check->numFragmented);
+    printf("%d bytes unused at the ends of files.\n", check->slack);
+    printf("Free: %d sectors in %d runs, the largest %d sectors.\n",
+	   numFree, numHoles, largest);
+
+    if (repair && check->problems > 0) {
+	for (i = 0; i < check->numBad; i++) {
+	    directory = FetchDir(check->badDir[i], &dirFile);
+	    if (directory->Find(check->badName[i]) == check->badSector[i])
+		directory->Remove(check->badName[i]);
+	    ReleaseDir(directory, dirFile, TRUE);
+	}
+	dentries->Clear();		// it may hold what we removed
+	for (i = 0; i < NumSectors; i++)
+	    if (check->owner[i] != -1)
+		freeMap->Mark(i);
+	    else
+		freeMap->Clear(i);
+	freeMapDirty = TRUE;
+	Flush();
+    }
+    problems = check->problems;
+    if (problems == 0)
+	printf("No problems found.\n");
+    else
+	printf("%d problems found%s.\n", problems,
+	       repair ? ", and repaired" : "");
+    lock->Release();
+
+    delete hdr;
+    delete check;
+    return problems;
 }
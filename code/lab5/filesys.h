@@ -20,9 +20,9 @@
 //	file system (in a file named "DISK"). 
 //
 //	In the "real" implementation, there are two key data structures used 
-//	in the file system.  There is a single "root" directory, listing
-//	all of the files in the file system; unlike UNIX, the baseline
-//	system does not provide a hierarchical directory structure.  
+//	in the file system.  There is a "root" directory, listing the
+//	files in the file system; as in UNIX, a directory can hold other
+//	directories, and files are named by paths such as "a/b/c".
 //	In addition, there is a bitmap for allocating
 //	disk sectors.  Both the root directory and the bitmap are themselves
 //	stored as files in the Nachos file system -- this causes an interesting
@@ -66,6 +66,16 @@ class FileSystem {
 };
 
 #else // FILESYS
+class BitMap;
+class Directory;
+class DentryCache;
+class Lock;
+
+// Changes to the free map and the root directory are kept in memory,
+// and committed to disk, through the journal, at most this many ticks
+// after the first of them (or sooner, by Sync).
+#define SyncInterval 		1000000
+
 class FileSystem {
   public:
     FileSystem(bool format);		// Initialize the file system.
@@ -74,19 +84,31 @@ class FileSystem {
     					// If "format", there is nothing on
 					// the disk, so initialize the directory
     					// and the bitmap of free blocks.
+    ~FileSystem();			// Write back anything outstanding
 
     bool Create(char *name, int initialSize);  	
 					// Create a file (UNIX creat)
+    bool Mkdir(char *name);		// Create a directory (UNIX mkdir)
 
     OpenFile* Open(char *name); 	// Open a file (UNIX open)
 
     bool Remove(char *name);  		// Delete a file (UNIX unlink)
 
+    bool Extend(FileHeader *hdr, int numBytes);
+					// Allocate space to grow a file
+    void Sync();			// Write the free map and the root
+					//  directory back, if changed, and
+					//  checkpoint the journal
+
     void List();			// List all the files in the file system
 	void DiskMessage();
 
     void Print();			// List all the files and their contents
 
+    int Check(bool repair);		// Check the disk for consistency
+					//  (and fix it, if "repair"); return
+					//  the number of problems found
+
 
 
   private:
@@ -94,6 +116,27 @@ class FileSystem {
 					// represented as a file
    OpenFile* directoryFile;		// "Root" directory -- list of 
 					// file names, represented as a file
+   DentryCache *dentries;		// Recent lookups of names
+
+   BitMap *freeMap;			// Free map, kept in memory
+   Directory *root;			// Root directory, kept in memory
+   bool freeMapDirty;			// Has freeMap changed since Sync?
+   int dirtySince;			// When the oldest change not yet
+					//  synced was made, or -1
+   bool sectorsFreed;			// Has Remove freed sectors since Sync?
+   Lock *lock;				// Protects all of the above
+
+   int Walk(char *path, char *name);	// Find the directory holding "path"
+   int Lookup(int dirSector, char *name, bool *isDir);
+					// Find "name" in a directory
+   Directory *FetchDir(int sector, OpenFile **file);
+					// Get a directory, and its file
+   void ReleaseDir(Directory *dir, OpenFile *file, bool changed);
+					// Done with it; write back changes
+   bool Make(char *path, int initialSize, bool isDir);
+					// Create a file or directory
+   void Changed();			// Note a change to freeMap or root
+   void Flush();			// Sync, with the lock already held
 };
 
 #endif // FILESYS
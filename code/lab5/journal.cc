@@ -0,0 +1,317 @@
+// journal.cc
+//	Routines for the file system's write-ahead journal.
+//
+//	A batch is committed in four steps:
+//	   Flush the disk cache, so that the previous batch, written in
+//	     place, and any file data the new batch points to, are on disk
+//	   Write the header and the sectors of the batch into the journal,
+//	     as one run of consecutive sectors
+//	   Flush again; once this is done, the batch is committed
+//	   Write the sectors of the batch in place, through the cache
+//
+//	The journal only ever holds the last batch, so it has to be on
+//	disk in place before the journal is overwritten with the next
+//	one -- which the first step sees to.  On mounting, the batch in
+//	the journal is written in place again (which does no harm if it
+//	already was), unless its checksum shows it was never completely
+//	written; and the header is then marked as replayed.  Checkpoint
+//	does the same when the file system is shut down cleanly, so that
+//	the next mount has nothing to do.
+//
+//	A batch holds at most JournalCapacity sectors.  The file system
+//	commits long before that; if a single operation changes more
+//	sectors than that, it is committed in pieces.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "journal.h"
+
+#include "copyright.h"
+#include "synch.h"
+#include "system.h"
+
+Journal *journal;
+
+//----------------------------------------------------------------------
+// Journal::Journal
+// 	Initialize the journal.  If "format", the disk has nothing on it,
+//	and we write an empty journal header; otherwise we replay the
+//	batch found in the journal, if any.
+//
+//	The caller makes sure nothing else is put in the sectors of the
+//	journal.
+//----------------------------------------------------------------------
+
+Journal::Journal(bool format) {
+    numPending = 0;
+    home = new int[JournalCapacity];
+    pending = new char[JournalCapacity * SectorSize];
+    sequence = commits = 0;
+    replayed = TRUE;
+    lock = new Lock("journal");
+    if (format)
+        Clear();
+    else
+        Replay();
+}
+
+//----------------------------------------------------------------------
+// Journal::~Journal
+// 	De-allocate the journal.  Anything still pending is lost; the
+//	file system checkpoints the journal before it is shut down.
+//----------------------------------------------------------------------
+
+Journal::~Journal() {
+    delete[] home;
+    delete[] pending;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// Journal::Find
+// 	Return the index of "sector" among the pending sectors, or if it
+//	is not there, the index it would be put at.
+//----------------------------------------------------------------------
+
+int Journal::Find(int sector) {
+    int low = 0, high = numPending;
+
+    while (low < high) {
+        int mid = (low + high) / 2;
+
+        if (home[mid] < sector)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+//----------------------------------------------------------------------
+// Journal::Read
+// Journal::ReadSectors
+// 	Read sectors[i] into data[i * SectorSize], as a SynchDisk would,
+//	except that a sector changed but not yet committed is copied from
+//	memory.
+//
+//	The disk is read without holding the lock; if a batch was
+//	committed in the meantime, what was read may be older than what
+//	was pending, so it is read again.
+//----------------------------------------------------------------------
+
+void Journal::Read(int sector, char *data) { ReadSectors(1, &sector, data); }
+
+void Journal::ReadSectors(int numSectors, int *sectors, char *data) {
+    int i, j, seen;
+
+    for (;;) {
+        seen = commits;
+        synchDisk->ReadSectors(numSectors, sectors, data);
+        lock->Acquire();
+        if (seen == commits) break;
+        lock->Release();
+    }
+    for (i = 0; i < numSectors && numPending > 0; i++) {
+        j = Find(sectors[i]);
+        if (j < numPending && home[j] == sectors[i])
+            bcopy(&pending[j * SectorSize], &data[i * SectorSize], SectorSize);
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// Journal::Write
+// Journal::WriteSectors
+// 	Note the new contents of sectors[i], data[i * SectorSize].  They
+//	go to disk with the next batch.  If there is no room for another
+//	sector, the pending ones are committed first.
+//----------------------------------------------------------------------
+
+void Journal::Write(int sector, char *data) { WriteSectors(1, &sector, data); }
+
+void Journal::WriteSectors(int numSectors, int *sectors, char *data) {
+    int i, j;
+
+    lock->Acquire();
+    for (i = 0; i < numSectors; i++) {
+        ASSERT(sectors[i] >= 0 && sectors[i] < NumSectors);
+        ASSERT(sectors[i] < JournalStart ||
+               sectors[i] >= JournalStart + JournalSectors);
+        j = Find(sectors[i]);
+        if (j == numPending || home[j] != sectors[i]) {
+            if (numPending == JournalCapacity) {
+                DEBUG('f', "Journal full, committing part of an operation.\n");
+                WriteOut();
+                j = 0;
+            }
+            bcopy(&pending[j * SectorSize], &pending[(j + 1) * SectorSize],
+                  (numPending - j) * SectorSize);
+            bcopy((char *)&home[j], (char *)&home[j + 1],
+                  (numPending - j) * sizeof(int));
+            home[j] = sectors[i];
+            numPending++;
+        }
+        bcopy(&data[i * SectorSize], &pending[j * SectorSize], SectorSize);
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// Journal::Forget
+// 	Drop the pending contents of "sector", if any, because it has
+//	been freed.  Otherwise the batch would log what the sector held
+//	before it was freed.  Once the batch is committed, the sector may
+//	be given to an ordinary file, whose data is not journaled; if
+//	Nachos then stopped before the journal was overwritten, replaying
+//	the batch would write the old contents over that data.
+//----------------------------------------------------------------------
+
+void Journal::Forget(int sector) {
+    int j;
+
+    lock->Acquire();
+    j = Find(sector);
+    if (j < numPending && home[j] == sector) {
+        numPending--;
+        bcopy(&pending[(j + 1) * SectorSize], &pending[j * SectorSize],
+              (numPending - j) * SectorSize);
+        bcopy((char *)&home[j + 1], (char *)&home[j],
+              (numPending - j) * sizeof(int));
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// Journal::Commit
+// Journal::WriteOut
+// 	Commit the pending sectors as one batch (see the top of the file).
+//	WriteOut expects the caller to hold the lock.
+//----------------------------------------------------------------------
+
+void Journal::Commit() {
+    lock->Acquire();
+    WriteOut();
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// Journal::Checkpoint
+// 	Commit the pending sectors, then wait for the disk to have them
+//	in place, and mark the journal as replayed.
+//----------------------------------------------------------------------
+
+void Journal::Checkpoint() {
+    lock->Acquire();
+    WriteOut();
+    if (!replayed) {
+        synchDisk->Flush();
+        Clear();
+        synchDisk->Flush();
+    }
+    lock->Release();
+}
+
+void Journal::WriteOut() {
+    char *buf;
+    int *sectors;
+    JournalHeader *hdr;
+    int i;
+
+    if (numPending == 0) return;
+    DEBUG('f', "Committing %d sectors to the journal.\n", numPending);
+    synchDisk->Flush();
+
+    buf = new char[(numPending + 1) * SectorSize];
+    sectors = new int[numPending + 1];
+    hdr = (JournalHeader *)buf;
+    bzero(buf, SectorSize);
+    hdr->magic = JournalMagic;
+    hdr->sequence = ++sequence;
+    hdr->numSectors = numPending;
+    bcopy((char *)home, (char *)hdr->home, numPending * sizeof(int));
+    bcopy(pending, &buf[SectorSize], numPending * SectorSize);
+    hdr->checksum = Checksum(hdr, &buf[SectorSize]);
+    for (i = 0; i <= numPending; i++) sectors[i] = JournalStart + i;
+    synchDisk->WriteSectors(numPending + 1, sectors, buf);
+    synchDisk->Flush();  // the batch is committed
+
+    synchDisk->WriteSectors(numPending, home, pending);
+    numPending = 0;
+    commits++;
+    replayed = FALSE;
+    delete[] sectors;
+    delete[] buf;
+}
+
+//----------------------------------------------------------------------
+// Journal::Replay
+// 	Write the batch found in the journal in place, if it was committed,
+//	and mark it as replayed.
+//----------------------------------------------------------------------
+
+void Journal::Replay() {
+    JournalHeader hdr;
+    char *data;
+    int *sectors;
+    int i;
+
+    synchDisk->ReadSector(JournalStart, (char *)&hdr);
+    if (hdr.magic != JournalMagic) {
+        DEBUG('f', "No journal on the disk.\n");
+        return;
+    }
+    sequence = hdr.sequence;
+    if (hdr.numSectors <= 0 || hdr.numSectors > JournalCapacity) return;
+
+    data = new char[hdr.numSectors * SectorSize];
+    sectors = new int[hdr.numSectors];
+    for (i = 0; i < hdr.numSectors; i++) sectors[i] = JournalStart + 1 + i;
+    synchDisk->ReadSectors(hdr.numSectors, sectors, data);
+    if (Checksum(&hdr, data) == hdr.checksum) {
+        DEBUG('f', "Replaying %d sectors of batch %d from the journal.\n",
+              hdr.numSectors, hdr.sequence);
+        synchDisk->WriteSectors(hdr.numSectors, hdr.home, data);
+        synchDisk->Flush();
+    } else {
+        DEBUG('f', "Batch %d in the journal is incomplete, ignored.\n",
+              hdr.sequence);
+    }
+    Clear();
+    synchDisk->Flush();
+    delete[] sectors;
+    delete[] data;
+}
+
+//----------------------------------------------------------------------
+// Journal::Clear
+// 	Write a journal header with no batch in it.  Whatever was in the
+//	journal must already be in place.
+//----------------------------------------------------------------------
+
+void Journal::Clear() {
+    JournalHeader hdr;
+
+    bzero((char *)&hdr, sizeof(hdr));
+    hdr.magic = JournalMagic;
+    hdr.sequence = sequence;
+    synchDisk->WriteSector(JournalStart, (char *)&hdr);
+    replayed = TRUE;
+}
+
+//----------------------------------------------------------------------
+// Journal::Checksum
+// 	Return a checksum of the batch described by "hdr", whose sectors
+//	are in "data", covering where they go as well as what they hold.
+//----------------------------------------------------------------------
+
+unsigned Journal::Checksum(JournalHeader *hdr, char *data) {
+    unsigned sum = hdr->sequence;
+    int i;
+
+    for (i = 0; i < hdr->numSectors; i++) sum = sum * 31 + hdr->home[i];
+    for (i = 0; i < hdr->numSectors * SectorSize; i++)
+        sum = sum * 31 + (unsigned char)data[i];
+    return sum;
+}
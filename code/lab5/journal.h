@@ -0,0 +1,90 @@
+// journal.h
+//	Data structures for the file system's write-ahead journal.
+//
+//	Sectors holding the file system's own data -- file headers,
+//	extent blocks, directories and the free map -- are not written
+//	in place as they change.  Their new contents are collected in
+//	memory, and every so often written together, in one sequential
+//	disk write, to the journal: a reserved run of sectors on the
+//	first track, next to the file system's other fixed sectors.  Only
+//	once that write is done are the sectors written to their real
+//	places.  If Nachos stops in between, the next mount finds them in
+//	the journal and writes them again, so a batch of changes is either
+//	all on disk or not there at all.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "copyright.h"
+#include "disk.h"
+
+class Lock;
+
+// The journal is a header sector followed by the sectors of one batch.
+// The header is also the commit record: a batch is only replayed if
+// the checksum in the header matches the sectors after it.
+
+#define JournalMagic 0x4a524e4c
+#define JournalCapacity (int)(SectorSize / sizeof(int) - 4)
+#define JournalSectors (JournalCapacity + 1)
+#define JournalStart 2  // after the free map and directory headers
+
+class JournalHeader {
+   public:
+    int magic;                  // JournalMagic, once formatted
+    int sequence;               // Number of the batch
+    int numSectors;             // Sectors in the batch; 0 if the
+                                //  batch has already been replayed
+    unsigned checksum;          // Of the batch, see Checksum
+    int home[JournalCapacity];  // Where each sector of it belongs
+};
+
+// The following class collects changed file system sectors, and
+// commits them to disk through the journal.  Until they are committed,
+// reads of those sectors are answered from memory.
+
+class Journal {
+   public:
+    Journal(bool format);  // Set up the journal region if "format";
+                           //  otherwise replay whatever was committed
+                           //  to it but perhaps not written in place
+    ~Journal();
+
+    void Read(int sector, char *data);   // Read/write a sector of file
+    void Write(int sector, char *data);  //  system data, through the
+                                         //  journal
+    void ReadSectors(int numSectors, int *sectors, char *data);
+    void WriteSectors(int numSectors, int *sectors, char *data);
+    void Forget(int sector);  // "sector" has been freed: drop any
+                              //  change to it not yet committed
+
+    int NumPending() { return numPending; }  // Sectors not yet committed
+    void Commit();  // Write the pending sectors to the journal, and
+                    //  then in place
+    void Checkpoint();  // Commit, and wait until the journal is no
+                        //  longer needed, so mounting has nothing
+                        //  to replay
+
+   private:
+    int numPending;  // Changed sectors held in memory, kept
+    int *home;       //  sorted by where they belong
+    char *pending;   // Their contents
+    int sequence;    // Number of the last batch committed
+    int commits;     // Batches committed since mounting
+    bool replayed;   // Is the last batch known to be in place?
+    Lock *lock;      // Protects all of the above
+
+    int Find(int sector);  // Where "sector" is, or would go, in "home"
+    void WriteOut();       // Commit, with the lock already held
+    void Replay();         // Redo the batch found in the journal
+    void Clear();          // Mark the journal as having no batch to redo
+    unsigned Checksum(JournalHeader *hdr, char *data);
+};
+
+extern Journal *journal;  // The mounted file system's journal
+
+#endif  // JOURNAL_H
@@ -8,16 +8,21 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
+// Usage: nachos -d <debugflags> -rs <random seed #> -mlfq -sp <stacks>
 //		-s -x <nachos file> -c <consoleIn> <consoleOut>
-//		-f -cp <unix file> <nachos file>
-//		-p <nachos file> -r <nachos file> -l -D -t
+//		-f -ds <policy> -dc <sectors> -ra <sectors> -db <backend>
+//		-dg <tracks> <sectors> -dt <seek> <rotation> -dl <model>
+//		-cp <unix file> <nachos file>
+//		-p <nachos file> -r <nachos file> -mkdir <nachos dir> -l -D -t
+//		-fsck [-fix]
 //              -n <network reliability> -m <machine id>
 //              -o <other machine id>
 //              -z
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -mlfq schedules threads with a multilevel feedback queue
+//    -sp sets how many stacks of finished threads are kept for reuse
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
@@ -27,12 +32,24 @@
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
+//    -ds sets the disk scheduling policy: fcfs, sstf, scan or clook
+//    -dc sets how many sectors the disk cache holds (0 for none)
+//    -ra sets how many sectors sequential file reads prefetch (0 for none)
+//    -db sets how the disk's UNIX file is accessed: file, mmap or msync
+//    -dg sets how many tracks the disk has, and sectors per track
+//    -dt sets how many ticks the disk takes to seek one track, and to
+//	rotate past one sector
+//    -dl sets how disk latency is modelled: track, ssd or zoned
 //    -cp copies a file from UNIX to Nachos
 //    -p prints a Nachos file to stdout
-//    -r removes a Nachos file from the file system
-//    -l lists the contents of the Nachos directory
+//    -r removes a Nachos file (or empty directory) from the file system
+//    -mkdir creates a Nachos directory; Nachos file names may be paths
+//	such as "dir/file"
+//    -l lists the contents of the Nachos directory tree
 //    -D prints the contents of the entire file system 
 //    -t tests the performance of the Nachos file system
+//    -fsck checks the file system for consistency, and prints how
+//	fragmented it is; with -fix, it also repairs what it finds
 //
 //  NETWORK
 //    -n sets the network reliability
@@ -144,6 +161,10 @@ main(int argc, char **argv)
 	    ASSERT(argc > 1);
 	    fileSystem->Remove(*(argv + 1));
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-mkdir")) {	// make a Nachos directory
+	    ASSERT(argc > 1);
+	    fileSystem->Mkdir(*(argv + 1));
+	    argCount = 2;
 	} else if (!strcmp(*argv, "-l")) {	// list Nachos directory
             fileSystem->List();
 	} else if (!strcmp(*argv, "-D")) {	// print entire filesystem
@@ -152,6 +173,12 @@ main(int argc, char **argv)
             PerformanceTest();
 	} else if (!strcmp(*argv, "-DI")){
 			fileSystem->DiskMessage();
+	} else if (!strcmp(*argv, "-fsck")) {	// check the file system
+	    if (argc > 1 && !strcmp(*(argv + 1), "-fix")) {
+		fileSystem->Check(TRUE);
+		argCount = 2;
+	    } else
+		fileSystem->Check(FALSE);
 	}
 #endif // FILESYS
 #ifdef NETWORK
@@ -165,6 +192,10 @@ main(int argc, char **argv)
         }
 #endif // NETWORK
     }
+#ifdef FILESYS
+    fileSystem->Sync();			// write back what the commands
+					// left in memory
+#endif // FILESYS
 
     currentThread->Finish();	// NOTE: if the procedure "main" 
 				// returns, then the program "nachos"
@@ -15,6 +15,7 @@
 
 #include "copyright.h"
 #include "filehdr.h"
+#include "journal.h"
 #include "system.h"
 
 //----------------------------------------------------------------------
@@ -29,7 +30,9 @@ OpenFile::OpenFile(int sector) {
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
     seekPosition = 0;
+    lastRead = readAhead = -1;
     headSector = sector;
+    logged = FALSE;
 }
 
 //----------------------------------------------------------------------
@@ -86,13 +89,18 @@ int OpenFile::Write(char *into, int numBytes) {
 //
 //	For ReadAt:
 //	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   request, but we only copy the part we are interested in.  If the
+//	   request starts where the last one left off, the file is being
+//	   read sequentially, and we read ahead.
 //	For WriteAt:
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
 //	   in the data that will be modified, and write back all the full
 //	   or partial sectors that are part of the request.
 //
+//	Sectors are read by way of the journal, which may hold a newer copy
+//	of them than the disk does.
+//
 //	"into" -- the buffer to contain the data to be read from disk
 //	"from" -- the buffer containing the data to be written to disk
 //	"numBytes" -- the number of bytes to transfer
@@ -103,6 +111,7 @@ int OpenFile::Write(char *into, int numBytes) {
 int OpenFile::ReadAt(char *into, int numBytes, int position) {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
+    int *sectors;
     char *buf;
 
     if ((numBytes <= 0) || (position >= fileLength)) return 0;  // check request
@@ -114,15 +123,29 @@ int OpenFile::ReadAt(char *into, int numBytes, int position) {
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
+    // read in all the full and partial sectors that we need, straight
+    // into the caller's buffer if the request is whole sectors
+    if (position % SectorSize == 0 && numBytes % SectorSize == 0)
+        buf = into;
+    else
+        buf = new char[numSectors * SectorSize];
+    sectors = new int[numSectors];
     for (i = firstSector; i <= lastSector; i++)
-        synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize),
-                              &buf[(i - firstSector) * SectorSize]);
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    journal->ReadSectors(numSectors, sectors, buf);
+    delete[] sectors;
 
     // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete[] buf;
+    if (buf != into) {
+        bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
+        delete[] buf;
+    }
+
+    if (firstSector == lastRead || firstSector == lastRead + 1)
+        ReadAhead(lastSector);
+    else
+        readAhead = -1;
+    lastRead = lastSector;
     return numBytes;
 }
 
@@ -131,6 +154,7 @@ int OpenFile::WriteAt(char *from, int numBytes, int position) {
     int fileLength = hdr->FileLength();
     int i, firstSector, lastSector, numSectors;
     bool firstAligned, lastAligned;
+    int *sectors;
     char *buf;
 
     if ((numBytes <= 0) ||
@@ -145,29 +169,69 @@ int OpenFile::WriteAt(char *from, int numBytes, int position) {
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    buf = new char[numSectors * SectorSize];
-
     firstAligned = (bool)(position == (firstSector * SectorSize));
     lastAligned =
         (bool)((position + numBytes) == ((lastSector + 1) * SectorSize));
 
+    sectors = new int[numSectors];
+    for (i = firstSector; i <= lastSector; i++)
+        sectors[i - firstSector] = hdr->ByteToSector(i * SectorSize);
+    if (firstAligned && lastAligned) {  // whole sectors: write them as is
+        Put(numSectors, sectors, from);
+        delete[] sectors;
+        return numBytes;
+    }
+    buf = new char[numSectors * SectorSize];
+
     // read in first and last sector, if they are to be partially modified
-    if (!firstAligned) ReadAt(buf, SectorSize, firstSector * SectorSize);
+    if (!firstAligned) journal->Read(sectors[0], buf);
     if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], SectorSize,
-               lastSector * SectorSize);
+        journal->Read(sectors[numSectors - 1],
+                      &buf[(lastSector - firstSector) * SectorSize]);
 
     // copy in the bytes we want to change
     bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
     // write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)
-        synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize),
-                               &buf[(i - firstSector) * SectorSize]);
+    Put(numSectors, sectors, buf);
+    delete[] sectors;
     delete[] buf;
     return numBytes;
 }
 
+//----------------------------------------------------------------------
+// OpenFile::Put
+// 	Write sectors[i] from data[i * SectorSize].  The sectors of a file
+//	holding file system data (a directory, or the free map) go through
+//	the journal; those of an ordinary file straight to the disk.
+//----------------------------------------------------------------------
+
+void OpenFile::Put(int numSectors, int *sectors, char *data) {
+    if (logged)
+        journal->WriteSectors(numSectors, sectors, data);
+    else
+        synchDisk->WriteSectors(numSectors, sectors, data);
+}
+
+//----------------------------------------------------------------------
+// OpenFile::ReadAhead
+// 	Start reading the "readAheadWindow" sectors of the file after
+//	"sector" into the disk cache, so that the next sequential read
+//	finds them there.  Sectors already read ahead are skipped.
+//	Following right behind a read, these mostly come out of the
+//	disk's track buffer.
+//----------------------------------------------------------------------
+
+void OpenFile::ReadAhead(int sector) {
+    int last = divRoundUp(hdr->FileLength(), SectorSize) - 1;
+    int i;
+
+    if (sector + readAheadWindow < last) last = sector + readAheadWindow;
+    for (i = max(sector, readAhead) + 1; i <= last; i++)
+        synchDisk->Prefetch(hdr->ByteToSector(i * SectorSize));
+    if (last > readAhead) readAhead = last;
+}
+
 //----------------------------------------------------------------------
 // OpenFile::Length
 // 	Return the number of bytes in the file.
@@ -178,18 +242,20 @@ int OpenFile::Length() { return hdr->FileLength(); }
 bool OpenFile::AppendSize(int numBytes) {
     hdr->updateTime();
     printf("Appending!\n");
-    OpenFile *mapFile = new OpenFile(0);  // bitmap header is in sector 0
-    BitMap *freeMap = new BitMap(NumSectors);
-    freeMap->FetchFrom(
-        mapFile);  // now freeMap is initialized with its content in disk.
-    if (!hdr->Append(freeMap, numBytes)) {
-        return FALSE;  // no enough space left
-    }
-    // map is updated, so we need to write it back to disk
+    // the file system allocates from its own copy of the free map
+    return fileSystem->Extend(hdr, numBytes);
+}
+
+//----------------------------------------------------------------------
+// OpenFile::Grow
+// 	Make the file "numBytes" longer, taking the space from "freeMap",
+//	and write the new file header to disk.  The caller writes back the
+//	free map.  Return FALSE, changing nothing, if the disk is full.
+//----------------------------------------------------------------------
 
-    freeMap->WriteBack(mapFile);
-    delete mapFile;
-    delete freeMap;
+bool OpenFile::Grow(BitMap *freeMap, int numBytes) {
+    if (!hdr->Append(freeMap, numBytes)) return FALSE;
+    hdr->WriteBack(headSector);
     return TRUE;
 }
 
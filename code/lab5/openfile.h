@@ -66,6 +66,7 @@ class OpenFile {
 
 #else  // FILESYS
 class FileHeader;
+class BitMap;
 class OpenFile {
    public:
     OpenFile(int sector);  // Open a file whose header is located
@@ -91,15 +92,29 @@ class OpenFile {
                    // than the UNIX idiom -- lseek to
                    // end of file, tell, lseek back
     bool AppendSize(int numBytes);  // Append the file size by numBytes
+    bool Grow(BitMap *freeMap, int numBytes);  // Same, allocating from
+                                               // the caller's free map
 
     void WriteBack();  // Write modifications to file header
                        // back to disk
+    void LogWrites() { logged = TRUE; }  // Send writes to the file
+                                         // through the journal
     void setTime(int given_time);
 
    private:
     FileHeader *hdr;   // Header for this file
     int seekPosition;  // Current position within the file
+    int lastRead;      // Last sector of the file read, or -1
+    int readAhead;     // Sectors up to this one have been read ahead
+
+    void ReadAhead(int sector);  // Prefetch the sectors following
+                                 // "sector", after a sequential read
+    void Put(int numSectors, int *sectors, char *data);
+    // Write sectors of the file, through
+    // the journal if need be
     int headSector;    // Sector number of the file header
+    bool logged;       // Does the file hold file system data,
+                       // written through the journal?
 };
 
 #endif  // FILESYS
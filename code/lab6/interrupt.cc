@@ -64,7 +64,9 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, _int param, int time,
 
 Interrupt::Interrupt() {
     level = IntOff;
-    pending = new List();
+    maxPending = 16;
+    pending = new PendingInterrupt *[maxPending];
+    numPending = numScheduled = 0;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -76,8 +78,8 @@ Interrupt::Interrupt() {
 //----------------------------------------------------------------------
 
 Interrupt::~Interrupt() {
-    while (!pending->IsEmpty()) delete (ListElement *)(pending->Remove());
-    delete pending;
+    while (numPending > 0) delete RemovePending();
+    delete[] pending;
 }
 
 //----------------------------------------------------------------------
@@ -268,7 +270,7 @@ void Interrupt::PrintInt(int n) {
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: push it on a binary heap ordered by due time.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -288,7 +290,65 @@ void Interrupt::Schedule(VoidFunctionPtr handler, _int arg, int fromNow,
           intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    toOccur->serial = numScheduled++;
+    InsertPending(toOccur);
+}
+
+//----------------------------------------------------------------------
+// Earlier
+// 	Order of the pending interrupt heap: by due time, and interrupts
+//	due at the same time in the order they were scheduled.
+//----------------------------------------------------------------------
+
+static bool Earlier(PendingInterrupt *a, PendingInterrupt *b) {
+    return (a->when < b->when) || (a->when == b->when && a->serial < b->serial);
+}
+
+//----------------------------------------------------------------------
+// Interrupt::InsertPending
+// 	Add an interrupt to the heap of pending interrupts, growing it
+//	if need be, and sift it up to its place.  O(log n).
+//----------------------------------------------------------------------
+
+void Interrupt::InsertPending(PendingInterrupt *toOccur) {
+    int i, parent;
+
+    if (numPending == maxPending) {
+        PendingInterrupt **bigger = new PendingInterrupt *[2 * maxPending];
+
+        for (i = 0; i < numPending; i++) bigger[i] = pending[i];
+        delete[] pending;
+        pending = bigger;
+        maxPending *= 2;
+    }
+    for (i = numPending++; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (!Earlier(toOccur, pending[parent])) break;
+        pending[i] = pending[parent];
+    }
+    pending[i] = toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::RemovePending
+// 	Take the next interrupt due, pending[0], off the heap of pending
+//	interrupts, and sift the last one down into the hole.  O(log n).
+//----------------------------------------------------------------------
+
+PendingInterrupt *Interrupt::RemovePending() {
+    PendingInterrupt *first = pending[0];
+    PendingInterrupt *last = pending[--numPending];
+    int i, child;
+
+    for (i = 0; (child = 2 * i + 1) < numPending; i = child) {
+        if (child + 1 < numPending &&
+            Earlier(pending[child + 1], pending[child]))
+            child++;
+        if (!Earlier(pending[child], last)) break;
+        pending[i] = pending[child];
+    }
+    pending[i] = last;
+    return first;
 }
 
 //----------------------------------------------------------------------
@@ -311,26 +371,24 @@ bool Interrupt::CheckIfDue(bool advanceClock) {
     ASSERT(level == IntOff);  // interrupts need to be disabled,
                               // to invoke an interrupt handler
     if (DebugIsEnabled('i')) DumpState();
-    PendingInterrupt *toOccur =
-        (PendingInterrupt *)pending->SortedRemove(&when);
-
-    if (toOccur == NULL)  // no pending interrupts
+    if (numPending == 0)  // no pending interrupts
         return FALSE;
 
+    PendingInterrupt *toOccur = pending[0];  // only look at it for now
+    when = toOccur->when;
     if (advanceClock && when > stats->totalTicks) {  // advance the clock
         stats->idleTicks += (when - stats->totalTicks);
         stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {  // not time yet, put it back
-        pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks) {  // not time yet
         return FALSE;
     }
 
     // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) &&
-        pending->IsEmpty()) {
-        pending->SortedInsert(toOccur, when);
+        numPending == 1) {
         return FALSE;
     }
+    RemovePending();
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n",
           intTypeNames[toOccur->type], toOccur->when);
@@ -372,7 +430,8 @@ void Interrupt::DumpState() {
            intLevelNames[level]);
     printf("Pending interrupts:\n");
     fflush(stdout);
-    pending->Mapcar(PrintPending);
+    for (int i = 0; i < numPending; i++)  // in heap order
+        PrintPending((_int)pending[i]);
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
@@ -18,6 +18,7 @@ Interrupt *interrupt;			// interrupt status
 Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
+bool mlfqScheduling = FALSE;		// multilevel feedback queue (-mlfq)
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -52,7 +53,8 @@ extern void Cleanup();
 //	which is what we wanted to context switch), we set a flag
 //	so that once the interrupt handler is done, it will appear as 
 //	if the interrupted thread called Yield at the point it is 
-//	was interrupted.
+//	was interrupted.  The scheduler decides whether to switch:
+//	round robin switches on every timer interrupt.
 //
 //	"dummy" is because every interrupt handler takes one argument,
 //		whether it needs it or not.
@@ -60,7 +62,7 @@ extern void Cleanup();
 static void
 TimerInterruptHandler(_int dummy)
 {
-    if (interrupt->getStatus() != IdleMode)
+    if (interrupt->getStatus() != IdleMode && scheduler->SliceExpired())
 	interrupt->YieldOnReturn();
 }
 
@@ -108,6 +110,12 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-mlfq")) {
+	    mlfqScheduling = TRUE;		// needs the timer
+	} else if (!strcmp(*argv, "-sp")) {
+	    ASSERT(argc > 1);
+	    stackPoolLimit = atoi(*(argv + 1));	// thread stacks kept
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
@@ -138,7 +146,7 @@ Initialize(int argc, char **argv)
     stats = new Statistics();			// collect statistics
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new Scheduler();		// initialize the ready queue
-    if (randomYield)				// start the timer (if needed)
+    if (randomYield || mlfqScheduling)		// start the timer (if needed)
 	timer = new Timer(TimerInterruptHandler, 0, randomYield);
 
     threadToBeDestroyed = NULL;
@@ -28,6 +28,8 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+extern bool mlfqScheduling;			// multilevel feedback queue
+						// scheduling (-mlfq)
 
 #ifdef USER_PROGRAM
 #include "machine.h"
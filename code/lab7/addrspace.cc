@@ -64,7 +64,7 @@ static void SwapHeader(NoffHeader *noffH) {
 //	"executable" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
 
-BitMap *AddrSpace::userMap = new BitMap(pnperp);
+CoreMap *AddrSpace::coreMap = NULL;  // physical frames in use
 
 AddrSpace::AddrSpace(OpenFile *executable, char *filename) {
     // ------------------ Constructor ------------------
@@ -78,6 +78,12 @@ AddrSpace::AddrSpace(OpenFile *executable, char *filename) {
         }
     }
     ASSERT(flag);
+    if (coreMap == NULL)  // physical memory is only sized at startup
+        coreMap = new CoreMap(numPhysPages);
+    virtualMem = new int[frameQuota];
+    framesUsed = p_vm = 0;
+    lastFault = 0;
+    swapFile = NULL;
 
     if (executable == NULL) {
         printf("Unable to open file %s\n", filename);
@@ -100,10 +106,8 @@ AddrSpace::AddrSpace(OpenFile *executable, char *filename) {
                            // to leave room for the stack
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
-    ASSERT(numPages <= NumPhysPages);  // check we're not trying
-                                       // to run anything too big --
-                                       // at least until we have
-                                       // virtual memory
+    // pages are brought in on demand, so the address space may be
+    // bigger than physical memory
 
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", numPages,
           size);
@@ -123,50 +127,53 @@ AddrSpace::AddrSpace(OpenFile *executable, char *filename) {
                                         // pages to be read-only
     }
 
-    bzero(machine->mainMemory, pnperp);
-    fileSystem->Create("VMFile", size);
-    OpenFile *vm = fileSystem->Open("VMFile");
-
-    if (vm == NULL) {
-        printf("Unable to open file %s\n", filename);
-        return;
-    }
+    // Each address space has a swap file of its own, kept open, so that
+    // page faults neither look it up again nor touch another program's
+    // pages.  It holds the address space byte for byte, so that page
+    // "vpn" is at vpn * PageSize in it, whatever the page size; it is
+    // written in full, so the pages of the stack and of uninitialized
+    // data come in as zeros.
+    sprintf(swapName, "SWAP%d", spaceID);
+    fileSystem->Create(swapName, size);
+    swapFile = fileSystem->Open(swapName);
+    ASSERT(swapFile != NULL);
 
     char *__VM__ = new char[size];
     // 将用户程序的内容写入磁盘的中间过渡
+    bzero(__VM__, size);
 
     if (noffH.code.size > 0) {
         DEBUG('a', "\tCopying code segment, at 0x%x, size %d\n",
               noffH.code.virtualAddr, noffH.code.size);
         executable->ReadAt(&(__VM__[noffH.code.virtualAddr]), noffH.code.size,
                            noffH.code.inFileAddr);
-        vm->WriteAt(&(__VM__[noffH.code.virtualAddr]), noffH.code.size,
-                    noffH.code.virtualAddr * PageSize);
     }
     if (noffH.initData.size > 0) {
         DEBUG('a', "\tCopying data segment, at 0x%x, size %d\n",
               noffH.initData.virtualAddr, noffH.initData.size);
         executable->ReadAt(&(__VM__[noffH.initData.virtualAddr]),
                            noffH.initData.size, noffH.initData.inFileAddr);
-        vm->WriteAt(&(__VM__[noffH.initData.virtualAddr]), noffH.initData.size,
-                    noffH.initData.virtualAddr * PageSize);
     }
-    //
-    delete vm;
+    swapFile->WriteAt(__VM__, size, 0);
+    delete[] __VM__;
 
     Print();
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space, and remove its swap file.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace() {
-    delete[] pageTable;
+    if (swapFile != NULL) {
+        delete swapFile;
+        fileSystem->Remove(swapName);
+    }
     for (int i = 0; i < numPages; i++) {
-        userMap->Clear(pageTable[i].physicalPage);
+        if (pageTable[i].valid) coreMap->Free(pageTable[i].physicalPage);
     }
+    delete[] pageTable;
     ThreadMap[spaceID] = 0;
     delete[] virtualMem;
 }
@@ -211,6 +218,7 @@ void AddrSpace::InitRegisters() {
 void AddrSpace::RestoreState() {
     machine->pageTable = pageTable;
     machine->pageTableSize = numPages;
+    machine->FlushTranslations();
 }
 
 void AddrSpace::Print() {
@@ -232,29 +240,23 @@ void AddrSpace::Print() {
 
 int AddrSpace::FIFO(int badVAddr) {
     // return 0 if no swap out.
-    // return 1 if swap out.
-    // return 2 if no VMFile.
-    // return 3 if no VMFile.
+    // return 1 if swap out, of a clean page.
+    // return 2 if swap out, of a dirty page written back.
     printf("--------------- FIFO Algorithm ---------------\n");
     int temp = 0;
-    if ((temp = userMap->Find()) != -1) {
+    if (framesUsed < frameQuota &&
+        (temp = coreMap->Allocate(this, &pageTable[PageNumber(badVAddr)])) !=
+            -1) {
         directSwapInRoutine(badVAddr, temp);
         return 0;
     }
+    ASSERT(framesUsed > 0);  // no free frame and nothing to replace
     int oldVPN = virtualMem[p_vm];
     int newVPN = badVAddr / PageSize;
     virtualMem[p_vm] = newVPN;
     advancePtr();
     writeBacked = Swap(oldVPN, newVPN);
-    OpenFile *executable = fileSystem->Open("VMFile");
-    if (executable == NULL) {
-        printf("Unable to open filssse %s\n", filename);
-        return 3;
-    }
-    executable->ReadAt(
-        &(machine->mainMemory[pageTable[newVPN].physicalPage * PageSize]),
-        PageSize, newVPN * PageSize);
-    delete executable;
+    ReadPage(newVPN);
     Print();
     return writeBacked + 1;
 }
@@ -271,23 +273,39 @@ int AddrSpace::Swap(int oldVPN, int newVPN) {
     pageTable[newVPN].valid = true;
     pageTable[newVPN].use = true;
     pageTable[newVPN].dirty = false;
+    coreMap->Assign(pageTable[newVPN].physicalPage, this, &pageTable[newVPN]);
+    machine->FlushTranslations();  // oldVPN is not mapped any more
     return writeBacked;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::ReadPage
+// AddrSpace::WritePage
+// 	Copy page "vpn" from the swap file into the frame the page table
+//	maps it to, or back out of it.  The swap file is already open, and
+//	where the page is in it is known, so no directory is searched.
+//----------------------------------------------------------------------
+
+void AddrSpace::ReadPage(int vpn) {
+    int frame = pageTable[vpn].physicalPage;
+
+    swapFile->ReadAt(&(machine->mainMemory[frame * PageSize]), PageSize,
+                     vpn * PageSize);
+    machine->InvalidateDecoded(frame);
+}
+
+void AddrSpace::WritePage(int vpn) {
+    swapFile->WriteAt(
+        &(machine->mainMemory[pageTable[vpn].physicalPage * PageSize]),
+        PageSize, vpn * PageSize);
+}
+
 // if dirty bit set to true, write back to disk
 int AddrSpace::writeBack(int oldVPN) {
     // if dirty, writeback and return 1.
     // if not dirty, refuse to writeback and return 0.
     if (pageTable[oldVPN].dirty) {
-        OpenFile *executable = fileSystem->Open("VMFile");
-        if (executable == NULL) {
-            printf("Unable to open files %s\n", filename);
-            return 0;
-        }
-        executable->WriteAt(
-            &(machine->mainMemory[pageTable[oldVPN].physicalPage * PageSize]),
-            PageSize, oldVPN * PageSize);
-        delete executable;
+        WritePage(oldVPN);
         return 1;
     }
     return 0;
@@ -296,14 +314,10 @@ int AddrSpace::writeBack(int oldVPN) {
 void AddrSpace::directSwapInRoutine(int badVAddr, int temp) {
     int newVPN = badVAddr / PageSize;
     printf("%d页写入,不需要写出旧页\n", newVPN);
-    virtualMem[p_vm] = newVPN;
-    advancePtr();
+    virtualMem[framesUsed++] = newVPN;
+    p_vm = 0;  // replacement starts from the oldest frame
     pageTable[newVPN].physicalPage = temp;
-    OpenFile *vm = fileSystem->Open("VMFile");
-    vm->ReadAt(
-        &(machine->mainMemory[pageTable[newVPN].physicalPage * PageSize]),
-        PageSize, newVPN * PageSize);
-    delete vm;
+    ReadPage(newVPN);
 
     pageTable[newVPN].valid = true;
     pageTable[newVPN].use = true;
@@ -315,14 +329,17 @@ void AddrSpace::directSwapInRoutine(int badVAddr, int temp) {
 int AddrSpace::clock(int badVAddr) {
     printf("--------------- CLOCK Algorithm ---------------\n");
     int temp = 0;
-    if ((temp = userMap->Find()) != -1) {
+    if (framesUsed < frameQuota &&
+        (temp = coreMap->Allocate(this, &pageTable[PageNumber(badVAddr)])) !=
+            -1) {
         directSwapInRoutine(badVAddr, temp);
         return 0;
     }
+    ASSERT(framesUsed > 0);  // no free frame and nothing to replace
     int oldVPN;
     int count = 0;  // circle count
     // search from (0, 0)
-    for (int i = 0; i < pnperp; ++i) {
+    for (int i = 0; i < framesUsed; ++i) {
         if (notUsednotDirty()) {
             oldVPN = ptrVPN();
             printf("第一轮，找到的要替换的页是：%d \n", oldVPN);
@@ -331,9 +348,9 @@ int AddrSpace::clock(int badVAddr) {
         advancePtr();
         count++;
     }
-    if (count == pnperp) {  // 2th
+    if (count == framesUsed) {  // 2th
         count = 0;
-        for (int i = 0; i < pnperp; i++) {
+        for (int i = 0; i < framesUsed; i++) {
             if (notUsedbutDirty()) {
                 oldVPN = ptrVPN();
                 printf("第二轮，找到的要替换的页是：%d \n", oldVPN);
@@ -345,9 +362,9 @@ int AddrSpace::clock(int badVAddr) {
             count++;
         }
     }
-    if (count == pnperp) {
+    if (count == framesUsed) {
         count = 0;
-        for (int i = 0; i < pnperp; ++i) {
+        for (int i = 0; i < framesUsed; ++i) {
             if (notUsednotDirty()) {
                 oldVPN = ptrVPN();
                 printf("第三轮，找到的要替换的页是：%d \n", oldVPN);
@@ -357,8 +374,8 @@ int AddrSpace::clock(int badVAddr) {
             count++;
         }
     }
-    if (count == pnperp) {
-        for (int i = 0; i < pnperp; ++i) {
+    if (count == framesUsed) {
+        for (int i = 0; i < framesUsed; ++i) {
             if (notUsedbutDirty()) {
                 oldVPN = ptrVPN();
                 printf("第四轮，找到的要替换的页是：%d \n", oldVPN);
@@ -372,15 +389,93 @@ int AddrSpace::clock(int badVAddr) {
     virtualMem[p_vm] = newVPN;
     advancePtr();  // moveback pointer
     writeBacked = Swap(oldVPN, newVPN);
-    OpenFile *executable = fileSystem->Open("VMFile");
-    if (executable == NULL) {
-        printf("Unable to open filssse %s\n", filename);
-        return 3;
-    }
-    executable->ReadAt(
-        &(machine->mainMemory[pageTable[newVPN].physicalPage * PageSize]),
-        PageSize, newVPN * PageSize);
-    delete executable;
+    ReadPage(newVPN);
     Print();
     return 1 + writeBacked;
-}
\ No newline at end of file
+}
+//----------------------------------------------------------------------
+// AddrSpace::GlobalFault
+// 	Bring in the page holding "badVAddr", with global replacement:
+//	into a free frame if there is one, and otherwise into the frame
+//	the core map's clock picks, whichever address space holds it.
+//	There is no quota; an address space holds as many frames as it
+//	keeps using.
+//
+//	With -pff, the page fault frequency also decides how many frames
+//	an address space holds: if it has gone more than pffInterval
+//	ticks without a fault, it has more than it needs, and gives up
+//	the pages it has not used since then (see TrimWorkingSet), so
+//	that address spaces that fault often find free frames.
+//
+//	Returns as FIFO and clock do: 0 if no page had to be replaced,
+//	1 if a clean one was, 2 if a dirty one was written back.
+//----------------------------------------------------------------------
+
+int AddrSpace::GlobalFault(int badVAddr) {
+    int newVPN = PageNumber(badVAddr);
+    int frame, result = 0;
+
+    printf("--------------- Global CLOCK Algorithm ---------------\n");
+    ASSERT((unsigned)newVPN < numPages);
+    if (pffInterval > 0) TrimWorkingSet();
+    lastFault = ::stats->totalTicks;  // the machine's, not our own
+
+    frame = coreMap->Allocate(this, &pageTable[newVPN]);
+    if (frame == -1) {
+        frame = coreMap->Victim();
+        AddrSpace *owner = coreMap->Owner(frame);
+        int oldVPN = coreMap->VirtualPage(frame);
+
+        printf("Swap out space %d page %d, swap in newVPN: %d (frame %d)\n",
+               owner->getSpaceID(), oldVPN, newVPN, frame);
+        result = 1 + owner->Evict(oldVPN);
+        frame = coreMap->Allocate(this, &pageTable[newVPN]);
+    }
+    ASSERT(frame != -1);
+    framesUsed++;
+    pageTable[newVPN].physicalPage = frame;
+    ReadPage(newVPN);
+    pageTable[newVPN].valid = true;
+    pageTable[newVPN].use = true;
+    pageTable[newVPN].dirty = false;
+    Print();
+    return result;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Evict
+// 	Give up the frame holding page "vpn": write the page back to the
+//	swap file if it is dirty, and unmap it.  Returns 1 if the page was
+//	written back, 0 if not.
+//----------------------------------------------------------------------
+
+int AddrSpace::Evict(int vpn) {
+    int written = writeBack(vpn);
+
+    pageTable[vpn].valid = false;
+    coreMap->Free(pageTable[vpn].physicalPage);
+    framesUsed--;
+    machine->FlushTranslations();  // in case this is the running space
+    return written;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TrimWorkingSet
+// 	Page fault frequency control, called at each page fault.  If the
+//	last fault was more than pffInterval ticks ago, give up every
+//	page not used since the last time we looked, and start looking
+//	again; the pages that are left are the working set.
+//----------------------------------------------------------------------
+
+void AddrSpace::TrimWorkingSet() {
+    if (::stats->totalTicks - lastFault <= pffInterval) return;
+    for (unsigned vpn = 0; vpn < numPages; vpn++) {
+        if (!pageTable[vpn].valid) continue;
+        if (!pageTable[vpn].use) {
+            printf("Space %d gives up page %d (frame %d)\n", spaceID, vpn,
+                   pageTable[vpn].physicalPage);
+            if (Evict(vpn)) ::stats->numWriteBacks++;
+        } else
+            pageTable[vpn].use = false;
+    }
+}
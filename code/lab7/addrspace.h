@@ -15,20 +15,25 @@
 
 #include "bitmap.h"
 #include "copyright.h"
+#include "coremap.h"
 #include "filesys.h"
 #include "noff.h"
 #include "stats.h"
 #include "translate.h"
 #define UserStackSize 1024  // increase this as necessary!
 
-#ifndef pnperp
-#define pnperp 5
-#endif
+#define DefaultFrameQuota 5  // frames a user program may hold at most
+
+extern int frameQuota;  // the quota actually in use (-mf, see system.cc)
+extern bool globalReplacement;  // replace across address spaces (-gr)
+extern int pffInterval;  // with -gr, give up pages unused for this many
+                         //  ticks of faulting (-pff); 0 not to
 
 #ifndef SWAP_STRATEGY
 #define SWAP_STRATEGY int
 #define STR__FIFO__ 1
 #define STR__CLOCK__ 2
+#define STR__GLOBAL__ 3
 #endif
 
 class AddrSpace {
@@ -66,25 +71,41 @@ class AddrSpace {
         return pageTable[virtualMem[p_vm]].virtualPage;
     }
 
-    inline void advancePtr() { p_vm = (p_vm + 1) % pnperp; }
+    inline void advancePtr() { p_vm = (p_vm + 1) % framesUsed; }
 
     void directSwapInRoutine(int badVAddr, int temp);
 
+    int GlobalFault(int badVAddr);  // Service a page fault, taking a
+                                    //  frame from any address space
+    int Evict(int vpn);             // Give up the frame of page "vpn",
+                                    //  writing it back if dirty
+
    private:
+    void ReadPage(int vpn);   // Bring page "vpn" in from the swap file
+    void WritePage(int vpn);  // Write page "vpn" back to the swap file
+    void TrimWorkingSet();    // Page-fault-frequency control, see
+                              //  GlobalFault
+
     TranslationEntry *pageTable;  // Assume linear page table translation
                                   // for now!
     unsigned int numPages;        // Number of pages in the virtual
                                   // address space
-    static BitMap *userMap;
+    static CoreMap *coreMap;  // Which frames hold which pages
     unsigned int spaceID;
 
     unsigned int StackPages;
     char *filename;
     NoffHeader noffH;
     Statistics *stats = new Statistics;
-    int virtualMem[pnperp];  // FIFO页顺序存储
-    int p_vm;                // FIFO换出页指针
+    int *virtualMem;  // FIFO页顺序存储, frameQuota entries
+    int framesUsed;   // entries of virtualMem in use
+    int p_vm;         // FIFO换出页指针
     int writeBacked;
+    int lastFault;  // When the last page fault was, for -pff
+    char swapName[16];   // SWAPn, n being the space id
+    OpenFile *swapFile;  // Backing store for the address space, page
+                         //  "vpn" at vpn * PageSize; open as long as
+                         //  the address space exists
 };
 
 #endif  // ADDRSPACE_H
@@ -0,0 +1,62 @@
+#!/bin/bash
+# bench-dispatch.sh
+#	Compare the two user-instruction interpreters of lab7: the opcode
+#	switch (the default build) and the direct-threaded one
+#	("make DISPATCH=threaded", see Makefile.local).
+#
+#	Both nachos binaries are built in a copy of the source tree, so
+#	that the build here is left alone.  Every test program is run under
+#	each of them, and the complete output -- including the statistics
+#	and the user register/memory checksum printed by -cs -- must be
+#	identical before the run times are reported.
+#
+#	usage: ./bench-dispatch.sh [program ...]	(default: sort matmult)
+#	Programs are taken from ../test/<program>.noff.  NACHOSFLAGS holds
+#	the nachos options (default "-np 64", as matmult needs more than
+#	the default 32 pages), and REPEAT sets the runs per timing.
+
+cd "$(dirname "$0")" || exit 1
+progs=${*:-sort matmult}
+repeat=${REPEAT:-3}
+flags=${NACHOSFLAGS--np 64}
+out=$(mktemp -d)
+trap 'rm -rf $out' EXIT
+
+cp -r .. $out/code
+for mode in switch threaded; do
+    make -C $out/code/lab7 clean > /dev/null 2>&1
+    if ! make -C $out/code/lab7 DISPATCH=$mode > $out/make.log 2>&1; then
+        cat $out/make.log
+        exit 1
+    fi
+    cp $out/code/lab7/nachos $out/nachos-$mode
+done
+
+status=0
+printf "%-12s %12s %12s\n" program switch threaded
+for prog in $progs; do
+    line=$(printf "%-12s" $prog)
+    for mode in switch threaded; do
+        start=$(date +%s.%N)
+        for ((i = 0; i < repeat; i++)); do
+            $out/nachos-$mode $flags -cs -x ../test/$prog.noff \
+                > $out/$prog.$mode 2>&1
+        done 2> /dev/null
+        end=$(date +%s.%N)
+        line="$line $(awk "BEGIN { printf \"%12.3f\", $end - $start }")"
+    done
+    if ! grep -q "User state checksum" $out/$prog.switch; then
+        echo "$line   FAILED:"
+        tail -3 $out/$prog.switch
+        status=1
+        continue
+    elif ! cmp -s $out/$prog.switch $out/$prog.threaded; then
+        line="$line   MISMATCH"
+        diff $out/$prog.switch $out/$prog.threaded | head -20
+        status=1
+    else
+        line="$line   identical"
+    fi
+    echo "$line"
+done
+exit $status
@@ -0,0 +1,61 @@
+#!/bin/bash
+# bench-pagesize.sh
+#	Compare page sizes (-ps) for the lab7 virtual memory: every test
+#	program is run once for each page size, and the page faults, the
+#	dirty pages written back to the swap file, the simulated ticks and
+#	the run time are reported.
+#
+#	Physical memory (MEMORY, default 8192 bytes) and the memory a
+#	program may hold (QUOTA, default 2048 bytes, cf. -mf) are the same
+#	number of bytes at every page size, so larger pages mean fewer
+#	frames.  Physical memory must hold the whole address space, and
+#	the quota should come to at least two frames.
+#
+#	usage: ./bench-pagesize.sh [program ...]	(default: sort matmult)
+#	Programs are taken from ../test/<program>.noff.  SIZES lists the
+#	page sizes (default "128 256 512 1024"), NACHOSFLAGS holds any
+#	further nachos options, and REPEAT sets the runs per timing.
+
+cd "$(dirname "$0")" || exit 1
+progs=${*:-sort matmult}
+sizes=${SIZES:-128 256 512 1024}
+memory=${MEMORY:-8192}
+quota=${QUOTA:-2048}
+repeat=${REPEAT:-3}
+flags=${NACHOSFLAGS-}
+out=$(mktemp -d)
+trap 'rm -rf $out' EXIT
+
+if ! make > $out/make.log 2>&1; then
+    cat $out/make.log
+    exit 1
+fi
+
+status=0
+printf "%-12s %6s %6s %8s %11s %10s %10s\n" program page frames faults \
+    "write backs" ticks seconds
+for prog in $progs; do
+    for size in $sizes; do
+        frames=$((quota / size))
+        start=$(date +%s.%N)
+        for ((i = 0; i < repeat; i++)); do
+            ./nachos -ps $size -np $((memory / size)) -mf $frames $flags \
+                -x ../test/$prog.noff > $out/$prog.$size 2>&1
+        done 2> /dev/null
+        end=$(date +%s.%N)
+        if ! grep -q "^Paging:" $out/$prog.$size; then
+            printf "%-12s %6d   FAILED:\n" $prog $size
+            tail -3 $out/$prog.$size
+            status=1
+            continue
+        fi
+        faults=$(sed -n 's/^Paging: faults \([0-9]*\).*/\1/p' $out/$prog.$size)
+        writes=$(sed -n 's/^Paging: .*write backs \([0-9]*\).*/\1/p' \
+            $out/$prog.$size)
+        ticks=$(sed -n 's/^Ticks: total \([0-9]*\).*/\1/p' $out/$prog.$size)
+        printf "%-12s %6d %6d %8d %11d %10d %10s\n" $prog $size $frames \
+            $faults $writes $ticks \
+            $(awk "BEGIN { printf \"%.3f\", ($end - $start) / $repeat }")
+    done
+done
+exit $status
@@ -4,6 +4,8 @@
 //
 //	Represented as an array of unsigned integers, on which we do
 //	modulo arithmetic to find the bit we are interested in.
+//	Searches look at a whole word at a time.  Find starts where the
+//	previous Find left off; FindRun starts where the caller asks.
 //
 //	The bitmap can be parameterized with with the number of bits being 
 //	managed.
@@ -43,6 +45,10 @@ class BitMap {
     int Find();            	// Return the # of a clear bit, and as a side
 				// effect, set the bit. 
 				// If no bits are clear, return -1.
+    int FindRun(int count, int from);	// Find and set "count"
+				// consecutive clear bits at or after
+				// "from", returning the first; -1 if
+				// there is no run that long.
     int NumClear();		// Return the number of clear bits
 
     void Print();		// Print contents of bitmap
@@ -59,6 +65,16 @@ class BitMap {
 					//  multiple of the number of bits in
 					//  a word)
     unsigned int *map;			// bit storage
+    int numClear;			// number of clear bits, kept up to
+					// date by Mark and Clear
+    int cursor;				// where the next search starts
+					// (next fit)
+
+    int NextClear(int from, int to);	// First clear bit in [from, to)
+    int NextSet(int from, int to);	// First set bit in [from, to)
+    void Recount();			// Recompute numClear, and set the
+					// bits past numBits so scans never
+					// return them
 };
 
 #endif // BITMAP_H
@@ -0,0 +1,103 @@
+// coremap.cc
+//	Routines to keep track of which address space holds each frame of
+//	physical memory, and to pick frames to replace across all of them.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "coremap.h"
+
+#include "addrspace.h"
+#include "copyright.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// CoreMap::CoreMap
+// 	Initialize the core map for "size" frames, all free.
+//----------------------------------------------------------------------
+
+CoreMap::CoreMap(int size) {
+    numFrames = size;
+    frames = new CoreMapEntry[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+        frames[i].owner = NULL;
+        frames[i].entry = NULL;
+    }
+    freeMap = new BitMap(numFrames);
+    hand = 0;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::~CoreMap
+// 	De-allocate the core map.
+//----------------------------------------------------------------------
+
+CoreMap::~CoreMap() {
+    delete[] frames;
+    delete freeMap;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Allocate
+// 	Find a free frame, and note it as holding the page of "space"
+//	that "entry" maps.  Return the frame, or -1 if all are in use.
+//	The caller fills in "entry".
+//----------------------------------------------------------------------
+
+int CoreMap::Allocate(AddrSpace *space, TranslationEntry *entry) {
+    int frame = freeMap->Find();
+
+    if (frame != -1) Assign(frame, space, entry);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Assign
+// 	Note that "frame", already in use, now holds the page of "space"
+//	that "entry" maps: the frame was taken from another page.
+//----------------------------------------------------------------------
+
+void CoreMap::Assign(int frame, AddrSpace *space, TranslationEntry *entry) {
+    ASSERT(frame >= 0 && frame < numFrames && freeMap->Test(frame));
+    frames[frame].owner = space;
+    frames[frame].entry = entry;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Free
+// 	Note that "frame" no longer holds anything.
+//----------------------------------------------------------------------
+
+void CoreMap::Free(int frame) {
+    ASSERT(frame >= 0 && frame < numFrames && freeMap->Test(frame));
+    frames[frame].owner = NULL;
+    frames[frame].entry = NULL;
+    freeMap->Clear(frame);
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Victim
+// 	Pick a frame to replace, whichever address space holds it, by the
+//	clock (second chance) algorithm: go round the frames from where
+//	the last search stopped, taking the first one whose page has not
+//	been used since the hand last passed it, and marking the others
+//	as unused as we go.  The second time round, some frame is bound
+//	to be unused.
+//----------------------------------------------------------------------
+
+int CoreMap::Victim() {
+    int frame;
+
+    ASSERT(freeMap->NumClear() == 0);
+    for (;;) {
+        frame = hand;
+        hand = (hand + 1) % numFrames;
+        if (!frames[frame].entry->use) break;
+        frames[frame].entry->use = FALSE;
+    }
+    DEBUG('a', "Clock picks frame %d, page %d of space %d\n", frame,
+          frames[frame].entry->virtualPage,
+          frames[frame].owner->getSpaceID());
+    return frame;
+}
@@ -0,0 +1,65 @@
+// coremap.h
+//	Data structures to keep track of physical memory: which page
+//	frames are free, and for each one in use, which address space
+//	and which of its pages it holds.
+//
+//	The reference and dirty state of a frame are those of the page
+//	table entry mapping it, which the hardware keeps up to date; the
+//	core map points at that entry rather than copying it.
+//
+//	With global replacement (-gr), a page fault that finds no free
+//	frame takes one from whichever address space has not used it
+//	lately, by running a clock over all of physical memory.  How
+//	many frames an address space holds then follows how much it
+//	uses, rather than a fixed quota.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COREMAP_H
+#define COREMAP_H
+
+#include "bitmap.h"
+#include "copyright.h"
+#include "translate.h"
+
+class AddrSpace;
+
+class CoreMapEntry {
+   public:
+    AddrSpace *owner;         // Address space using the frame, or NULL
+    TranslationEntry *entry;  // Its page table entry for the frame
+};
+
+// The following class describes all of physical memory, one entry per
+// frame.
+
+class CoreMap {
+   public:
+    CoreMap(int size);  // All frames start out free
+    ~CoreMap();
+
+    int Allocate(AddrSpace *space, TranslationEntry *entry);
+    // Give a free frame to the page of
+    //  "space" that "entry" maps;
+    //  -1 if there is none
+    void Assign(int frame, AddrSpace *space, TranslationEntry *entry);
+    // Note a frame now holding another page
+    void Free(int frame);  // Put a frame back on the free list
+
+    int Victim();  // The frame the clock picks to be
+                   //  replaced; all frames are in use
+
+    AddrSpace *Owner(int frame) { return frames[frame].owner; }
+    int VirtualPage(int frame) { return frames[frame].entry->virtualPage; }
+    int NumFree() { return freeMap->NumClear(); }
+
+   private:
+    int numFrames;         // Frames of physical memory
+    CoreMapEntry *frames;  // What each frame holds
+    BitMap *freeMap;       // Which frames are in use
+    int hand;              // Where the clock stopped last time
+};
+
+#endif  // COREMAP_H
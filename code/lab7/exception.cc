@@ -66,8 +66,17 @@ void ExceptionHandler(ExceptionType which) {
         switch (type) {
             case SC_Halt:
                 DEBUG('a', "Shutdown, initiated by user program.\n");
+                delete currentThread->space;  // remove its swap file
+                currentThread->space = NULL;
                 interrupt->Halt();
                 return;
+            case SC_Exit:
+                DEBUG('a', "Exit(%d), initiated by user program.\n",
+                      machine->ReadRegister(4));
+                delete currentThread->space;  // frees its frames, and
+                currentThread->space = NULL;  // removes its swap file
+                currentThread->Finish();
+                return;
             case SC_Exec:
                 interrupt->Exec();
                 AdvancePC();
@@ -78,7 +87,7 @@ void ExceptionHandler(ExceptionType which) {
                 AdvancePC();
                 return;
             default:
-                printf("Unexpected system call: %d, Expected: 0 for Halt, 2 for Exec, 11 for PrintInt.\n", type);
+                printf("Unexpected system call: %d, Expected: 0 for Halt, 1 for Exit, 2 for Exec, 11 for PrintInt.\n", type);
         }
 
     } else if ((which == PageFaultException)) {
@@ -68,7 +68,9 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, _int param, int time,
 
 Interrupt::Interrupt() {
     level = IntOff;
-    pending = new List();
+    maxPending = 16;
+    pending = new PendingInterrupt *[maxPending];
+    numPending = numScheduled = 0;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -80,8 +82,8 @@ Interrupt::Interrupt() {
 //----------------------------------------------------------------------
 
 Interrupt::~Interrupt() {
-    while (!pending->IsEmpty()) delete (ListElement *)(pending->Remove());
-    delete pending;
+    while (numPending > 0) delete RemovePending();
+    delete[] pending;
 }
 
 //----------------------------------------------------------------------
@@ -232,6 +234,10 @@ void Interrupt::Idle() {
 void Interrupt::Halt() {
     printf("Machine halting!\n\n");
     stats->Print();
+#ifdef USER_PROGRAM
+    if (checksumOnHalt && machine != NULL)
+        printf("User state checksum: 0x%08x\n", machine->Checksum());
+#endif
     Cleanup();  // Never returns.
 }
 
@@ -240,7 +246,7 @@ void Interrupt::Halt() {
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: push it on a binary heap ordered by due time.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -260,7 +266,78 @@ void Interrupt::Schedule(VoidFunctionPtr handler, _int arg, int fromNow,
           intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    toOccur->serial = numScheduled++;
+    InsertPending(toOccur);
+}
+
+//----------------------------------------------------------------------
+// Earlier
+// 	Order of the pending interrupt heap: by due time, and interrupts
+//	due at the same time in the order they were scheduled.
+//----------------------------------------------------------------------
+
+static bool Earlier(PendingInterrupt *a, PendingInterrupt *b) {
+    return (a->when < b->when) || (a->when == b->when && a->serial < b->serial);
+}
+
+//----------------------------------------------------------------------
+// Interrupt::InsertPending
+// 	Add an interrupt to the heap of pending interrupts, growing it
+//	if need be, and sift it up to its place.  O(log n).
+//----------------------------------------------------------------------
+
+void Interrupt::InsertPending(PendingInterrupt *toOccur) {
+    int i, parent;
+
+    if (numPending == maxPending) {
+        PendingInterrupt **bigger = new PendingInterrupt *[2 * maxPending];
+
+        for (i = 0; i < numPending; i++) bigger[i] = pending[i];
+        delete[] pending;
+        pending = bigger;
+        maxPending *= 2;
+    }
+    for (i = numPending++; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (!Earlier(toOccur, pending[parent])) break;
+        pending[i] = pending[parent];
+    }
+    pending[i] = toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::RemovePending
+// 	Take the next interrupt due, pending[0], off the heap of pending
+//	interrupts, and sift the last one down into the hole.  O(log n).
+//----------------------------------------------------------------------
+
+PendingInterrupt *Interrupt::RemovePending() {
+    PendingInterrupt *first = pending[0];
+    PendingInterrupt *last = pending[--numPending];
+    int i, child;
+
+    for (i = 0; (child = 2 * i + 1) < numPending; i = child) {
+        if (child + 1 < numPending &&
+            Earlier(pending[child + 1], pending[child]))
+            child++;
+        if (!Earlier(pending[child], last)) break;
+        pending[i] = pending[child];
+    }
+    pending[i] = last;
+    return first;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::QuietTicks
+// 	Return how many ticks simulated time can advance without any
+//	pending interrupt becoming due, so that the CPU simulation can
+//	skip the per-instruction OneTick for that long.  Zero (or less)
+//	means the next tick has to go through OneTick.
+//----------------------------------------------------------------------
+
+int Interrupt::QuietTicks() {
+    if (numPending == 0) return MaxQuietTicks;
+    return pending[0]->when - stats->totalTicks - 1;
 }
 
 //----------------------------------------------------------------------
@@ -283,26 +360,24 @@ bool Interrupt::CheckIfDue(bool advanceClock) {
     ASSERT(level == IntOff);  // interrupts need to be disabled,
                               // to invoke an interrupt handler
     if (DebugIsEnabled('i')) DumpState();
-    PendingInterrupt *toOccur =
-        (PendingInterrupt *)pending->SortedRemove(&when);
-
-    if (toOccur == NULL)  // no pending interrupts
+    if (numPending == 0)  // no pending interrupts
         return FALSE;
 
+    PendingInterrupt *toOccur = pending[0];  // only look at it for now
+    when = toOccur->when;
     if (advanceClock && when > stats->totalTicks) {  // advance the clock
         stats->idleTicks += (when - stats->totalTicks);
         stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {  // not time yet, put it back
-        pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks) {  // not time yet
         return FALSE;
     }
 
     // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) &&
-        pending->IsEmpty()) {
-        pending->SortedInsert(toOccur, when);
+        numPending == 1) {
         return FALSE;
     }
+    RemovePending();
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n",
           intTypeNames[toOccur->type], toOccur->when);
@@ -344,7 +419,8 @@ void Interrupt::DumpState() {
            intLevelNames[level]);
     printf("Pending interrupts:\n");
     fflush(stdout);
-    pending->Mapcar(PrintPending);
+    for (int i = 0; i < numPending; i++)  // in heap order
+        PrintPending((_int)pending[i]);
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
@@ -370,6 +446,7 @@ int Interrupt::Exec() {
     printf("Execute system call of Exec()\n");
     // read argument
     char filename[50];
+    int spaceID;
     int addr = machine->ReadRegister(4);
     int i = 0;
     do {
@@ -389,6 +466,9 @@ int Interrupt::Exec() {
 
     // new address space
     space = new AddrSpace(executable, filename);
+    spaceID = space->getSpaceID();  // the child may have exited, and its
+                                    // space been deleted, by the time
+                                    // we run again
     delete executable;  // close file
 
     // new and fork thread
@@ -399,7 +479,7 @@ int Interrupt::Exec() {
     currentThread->Yield();
 
     // return spaceID 向寄存器里写入spaceID
-    machine->WriteRegister(2, space->getSpaceID());
+    machine->WriteRegister(2, spaceID);
 }
 
 void Interrupt::PrintInt() {
@@ -420,10 +500,12 @@ bool Interrupt::PageFault() {
         t = space->FIFO(badVAddr);
     } else if (swap_strategy == STR__CLOCK__) {
         t = space->clock(badVAddr);
+    } else if (swap_strategy == STR__GLOBAL__) {
+        t = space->GlobalFault(badVAddr);
     } else {
         printf(
-            "Unknown swap swap_strategy: %d, expect 1 for FIFO or 2 for "
-            "CLOCK.\n",
+            "Unknown swap swap_strategy: %d, expect 1 for FIFO, 2 for "
+            "CLOCK or 3 for GLOBAL.\n",
             swap_strategy);
         ASSERT(false);
     }
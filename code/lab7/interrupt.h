@@ -40,6 +40,10 @@
 #include "list.h"
 #include "stats.h"
 
+// Longest stretch of simulated time QuietTicks hands out when nothing
+// is pending, so that user time still gets charged every so often.
+#define MaxQuietTicks 10000
+
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
 
@@ -75,6 +79,8 @@ class PendingInterrupt {
     _int arg;                 // The argument to the function.
     int when;                 // When the interrupt is supposed to fire
     IntType type;             // for debugging
+    int serial;               // Order of scheduling, to break ties
+                              // between interrupts due at the same time
 };
 
 // The following class defines the data structures for the simulation
@@ -124,6 +130,9 @@ class Interrupt {
 
     void OneTick();  // Advance simulated time
 
+    int QuietTicks();  // How many ticks can pass before the
+                       // next pending interrupt becomes due
+
     // lab6---------------------
     void AdvancePC();
     // void StartProcess(int n);
@@ -134,8 +143,12 @@ class Interrupt {
 
    private:
     IntStatus level;       // are interrupts enabled or disabled?
-    List *pending;         // the list of interrupts scheduled
-                           // to occur in the future
+    PendingInterrupt **pending;  // the interrupts scheduled to occur in
+                                 // the future, as a binary heap: the next
+                                 // one due is always pending[0]
+    int numPending;              // how many of them there are
+    int maxPending;              // room in "pending"
+    int numScheduled;            // interrupts scheduled so far
     bool inHandler;        // TRUE if we are running an interrupt handler
     bool yieldOnReturn;    // TRUE if we are to context switch
                            // on return from the interrupt handler
@@ -145,6 +158,9 @@ class Interrupt {
 
     bool CheckIfDue(bool advanceClock);  // Check if an interrupt is supposed
                                          // to occur now
+    void InsertPending(PendingInterrupt *toOccur);
+    PendingInterrupt *RemovePending();  // Add to, or take the next one
+                                        // off, the heap of pending interrupts
 
     void ChangeLevel(IntStatus old,   // SetLevel, without advancing the
                      IntStatus now);  // simulated time
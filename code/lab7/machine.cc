@@ -61,9 +61,18 @@ Machine::Machine(bool debug) {
     for (i = 0; i < NumTotalRegs; i++) registers[i] = 0;
     mainMemory = new char[MemorySize];
     for (i = 0; i < MemorySize; i++) mainMemory[i] = 0;
+    decodeCache = new Instruction[numPhysPages * InstrsPerPage];
+    decodeValid = new bool[numPhysPages * InstrsPerPage];
+    for (i = 0; i < numPhysPages; i++) InvalidateDecoded(i);
+    translationCache = new CachedTranslation[TranslationCacheSize];
+    FlushTranslations();
+    lastEntry = NULL;
+    traceMemory = DebugIsEnabled('a');
+    blockLength = blockLimit = 0;
+    trapped = FALSE;
 #ifdef USE_TLB
-    tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++) tlb[i].valid = FALSE;
+    tlb = new TranslationEntry[tlbSize];
+    for (i = 0; i < tlbSize; i++) tlb[i].valid = FALSE;
     pageTable = NULL;
 #else  // use linear page table
     tlb = NULL;
@@ -81,6 +90,9 @@ Machine::Machine(bool debug) {
 
 Machine::~Machine() {
     delete[] mainMemory;
+    delete[] decodeCache;
+    delete[] decodeValid;
+    delete[] translationCache;
     if (tlb != NULL) delete[] tlb;
 }
 
@@ -98,11 +110,15 @@ void Machine::RaiseException(ExceptionType which, int badVAddr) {
     DEBUG('m', "Exception: %s\n", exceptionNames[which]);
 
     //  ASSERT(interrupt->getStatus() == UserMode);
+    stats->totalTicks += blockLength * UserTick;  // the kernel must see
+    stats->userTicks += blockLength * UserTick;   // the time of the trap
+    blockLength = 0;
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);  // finish anything in progress
     interrupt->setStatus(SystemMode);
     ExceptionHandler(which);  // interrupts are enabled at this point
     interrupt->setStatus(UserMode);
+    trapped = TRUE;  // after the handler: it may have run other threads
 }
 
 //----------------------------------------------------------------------
@@ -200,3 +216,47 @@ void Machine::WriteRegister(int num, int value) {
     // DEBUG('m', "WriteRegister %d, value %d\n", num, value);
     registers[num] = value;
 }
+
+//----------------------------------------------------------------------
+// Machine::InvalidateDecoded
+//   	Throw away the pre-decoded instructions of physical page "frame".
+//	Stores through WriteMem keep the cache up to date by themselves;
+//	this is for the kernel, which fills frames directly.
+//----------------------------------------------------------------------
+
+void Machine::InvalidateDecoded(int frame) {
+    ASSERT((frame >= 0) && (frame < numPhysPages));
+    for (int i = 0; i < InstrsPerPage; i++)
+        decodeValid[frame * InstrsPerPage + i] = FALSE;
+}
+
+//----------------------------------------------------------------------
+// Machine::FlushTranslations
+//   	Forget every cached translation (see FastTranslate).  The cache
+//	holds pointers to page table/TLB entries and frames, so it has to
+//	be flushed whenever the kernel switches page tables or changes a
+//	mapping; clearing use and dirty bits is fine without a flush.
+//----------------------------------------------------------------------
+
+void Machine::FlushTranslations() {
+    for (int i = 0; i < TranslationCacheSize; i++) translationCache[i].vpn = -1;
+}
+
+//----------------------------------------------------------------------
+// Machine::Checksum
+//   	Return a hash (FNV-1a) of the CPU registers and all of main memory.
+//	Two runs of the same program that end with the same checksum (and
+//	the same statistics) executed identically, whichever interpreter
+//	loop ran them.
+//----------------------------------------------------------------------
+
+unsigned int Machine::Checksum() {
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < NumTotalRegs; i++)
+        hash = (hash ^ (unsigned int)registers[i]) * 16777619u;
+    for (i = 0; i < MemorySize; i++)
+        hash = (hash ^ (unsigned char)mainMemory[i]) * 16777619u;
+    return hash;
+}
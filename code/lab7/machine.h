@@ -28,14 +28,24 @@
 
 // Definitions related to the size, and format of user memory
 
-#define PageSize \
-    SectorSize  // set the page size equal to
-                // the disk sector size, for
-                // simplicity
+// The page size is a power-of-two multiple of the disk sector size,
+// set at startup; it is kept as a shift, so that splitting an address
+// into page number and offset stays a shift and a mask.
 
-#define NumPhysPages 32
-#define MemorySize (NumPhysPages * PageSize)
-#define TLBSize 4  // if there is a TLB, make it small
+#define PageSize (1 << pageShift)
+#define PageNumber(addr) ((unsigned)(addr) >> pageShift)
+#define PageOffset(addr) ((unsigned)(addr) & (PageSize - 1))
+
+#define DefaultPageSize SectorSize
+#define DefaultPhysPages 32
+#define DefaultTLBSize 4  // if there is a TLB, make it small
+
+extern int pageShift;     // log2 of the page size (-ps, see system.cc)
+extern int numPhysPages;  // physical page frames (-np, see system.cc)
+extern int tlbSize;       // TLB entries, if there is a TLB (-tlb)
+
+#define MemorySize (numPhysPages * PageSize)
+#define InstrsPerPage (PageSize / 4)  // instruction words per page
 
 enum ExceptionType {
     NoException,            // Everything ok!
@@ -92,6 +102,22 @@ class Instruction {
     unsigned char rs, rt, rd;  // Three registers from instruction.
     int extra;                 // Immediate or target or shamt field or offset.
                                // Immediates are sign-extended.
+#ifdef THREADED_DISPATCH
+    void *handler;  // where OneInstruction handles this opCode
+#endif
+};
+
+// One slot of the machine's direct-mapped translation cache (see
+// Machine::FastTranslate): the page table or TLB entry Translate found
+// for virtual page "vpn", and where that page lives in mainMemory.
+
+#define TranslationCacheSize 64  // must be a power of two
+
+class CachedTranslation {
+   public:
+    int vpn;                  // cached virtual page, -1 if the slot is empty
+    TranslationEntry *entry;  // its page table/TLB entry
+    char *page;               // start of its frame in mainMemory
 };
 
 // The following class defines the simulated host workstation hardware, as
@@ -121,12 +147,38 @@ class Machine {
     void WriteRegister(int num, int value);
     // store a value into a CPU register
 
+    unsigned int Checksum();
+    // Hash of the user registers and main
+    // memory, to check that two runs ended
+    // in exactly the same state
+
+    void FlushTranslations();
+    // Empty the translation cache; must be
+    // called on every change to the active
+    // page table or TLB other than clearing
+    // use/dirty bits (RestoreState, paging)
+
+    void InvalidateDecoded(int frame);
+    // Forget the pre-decoded instructions of
+    // a physical page; must be called whenever
+    // the kernel refills a frame behind the
+    // simulator's back (e.g. on page replacement)
+
     // Routines internal to the machine simulation -- DO NOT call these
 
     void OneInstruction(Instruction *instr);
     // Run one instruction of a user program.
+    bool RunBlock(Instruction *instr);
+    // Run user instructions up to the next
+    // interrupt deadline or trap, charging
+    // their ticks in one step.  TRUE if it
+    // ended in a trap.
     void DelayedLoad(int nextReg, int nextVal);
     // Do a pending delayed load (modifying a reg)
+    bool FetchInstruction(Instruction *instr);
+    // Fetch and decode the instruction at PC,
+    // using the pre-decoded copy when there is
+    // one.  Return FALSE if the fetch faulted.
 
     bool ReadMem(int addr, int size, int *value);
     bool WriteMem(int addr, int size, int value);
@@ -134,6 +186,14 @@ class Machine {
     // memory (at addr).  Return FALSE if a
     // correct translation couldn't be found.
 
+    char *FastTranslate(int virtAddr, int size, bool writing);
+    // Look "virtAddr" up in the translation
+    // cache, returning where it is in
+    // mainMemory or NULL on a miss
+    void CacheTranslation(int virtAddr);
+    // Remember the translation the last
+    // successful Translate found
+
     ExceptionType Translate(int virtAddr, int *physAddr, int size,
                             bool writing);
     // Translate an address, and check for
@@ -186,6 +246,19 @@ class Machine {
     unsigned int pageTableSize;
 
    private:
+    Instruction *decodeCache;  // pre-decoded copy of every word of
+                               // mainMemory, InstrsPerPage per frame
+    bool *decodeValid;         // is decodeCache[i] current?
+    CachedTranslation *translationCache;  // recent translations by vpn
+    TranslationEntry *lastEntry;  // entry found by the last Translate
+    bool traceMemory;             // 'a' debugging: always use Translate
+
+    int blockLength;  // instructions run by RunBlock whose ticks
+                      // have not been charged yet
+    bool trapped;     // set when the running block trapped to the kernel
+    int blockLimit;   // length of the block OneInstruction runs
+                      // threaded; 0 to run just one instruction
+
     bool singleStep;   // drop back into the debugger after each
                        // simulated instruction
     int runUntilTime;  // drop back into the debugger when simulated
@@ -8,9 +8,13 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
-//		-s -x <nachos file> -c <consoleIn> <consoleOut>
-//		-f -cp <unix file> <nachos file>
+// Usage: nachos -d <debugflags> -rs <random seed #> -mlfq -sp <stacks>
+//		-s -cs -ps <bytes> -np <pages> -tlb <entries> -mf <frames>
+//		-gr -pff <ticks>
+//		-x <nachos file> -c <consoleIn> <consoleOut>
+//		-f -ds <policy> -dc <sectors> -ra <sectors> -db <backend>
+//		-dg <tracks> <sectors> -dt <seek> <rotation> -dl <model>
+//		-cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -e <network orderability>
 //              -m <machine id>
@@ -19,15 +23,36 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -mlfq schedules threads with a multilevel feedback queue
+//    -sp sets how many stacks of finished threads are kept for reuse
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -cs prints a checksum of the user registers and memory at halt
+//    -ps sets the page size, a power-of-two multiple of the sector size
+//	(default 128)
+//    -np sets the number of physical page frames (default 32)
+//    -tlb sets the number of TLB entries (default 4)
+//    -mf sets the most frames one user program may hold (default 5)
+//    -gr replaces pages globally, across all user programs, by a clock
+//	over all of physical memory; -mf is then ignored
+//    -pff with -gr, makes a user program that goes more than this many
+//	ticks without a page fault give up the pages it has not used
+//	lately (default 0, never)
 //    -x runs a user program
 //    -c tests the console
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
+//    -ds sets the disk scheduling policy: fcfs, sstf, scan or clook
+//    -dc sets how many sectors the disk cache holds (0 for none)
+//    -ra sets how many sectors sequential file reads prefetch (0 for none)
+//    -db sets how the disk's UNIX file is accessed: file, mmap or msync
+//    -dg sets how many tracks the disk has, and sectors per track
+//    -dt sets how many ticks the disk takes to seek one track, and to
+//	rotate past one sector
+//    -dl sets how disk latency is modelled: track, ssd or zoned
 //    -cp copies a file from UNIX to Nachos
 //    -p prints a Nachos file to stdout
 //    -r removes a Nachos file from the file system
@@ -84,6 +109,7 @@ int main(int argc, char **argv) {
     (void)Initialize(argc, argv);
     swap_strategy = STR__CLOCK__;
     // swap_strategy = STR__FIFO__;
+    if (globalReplacement) swap_strategy = STR__GLOBAL__;
 
 #ifdef THREADS
 //    ThreadTest();
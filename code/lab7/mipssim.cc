@@ -18,6 +18,46 @@
 
 static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
 
+// THREADED_DISPATCH (see Makefile.local) turns OneInstruction into a
+// direct-threaded interpreter while Machine::RunBlock is running a
+// block: every cached decoded instruction carries the address of its
+// handler, and each handler ends by finishing its instruction, fetching
+// the next one and jumping straight to that handler.  The indirect
+// jump is thus repeated once per opcode, rather than shared by every
+// instruction going through the switch, which predicts much better.
+// The handlers are the cases of the switch, so both engines run the
+// very same code.  This needs GCC's computed goto ("labels as values").
+
+#if defined(THREADED_DISPATCH) && !defined(__GNUC__)
+#undef THREADED_DISPATCH
+#endif
+
+#ifdef THREADED_DISPATCH
+static void **handlerTable = NULL;	// opCode -> handler in OneInstruction
+
+#define OPCODE(op)	case op: do_##op:
+#define HANDLER(op)	table[op] = &&do_##op
+
+// End of a case: in the switch just break; in a threaded block, finish
+// the instruction like the code after the switch does, and go on with
+// the next one until the block is used up or something traps.
+#define NEXT								\
+    if (blockLimit == 0)						\
+	break;								\
+    DelayedLoad(nextLoadReg, nextLoadValue);				\
+    registers[PrevPCReg] = registers[PCReg];				\
+    registers[PCReg] = registers[NextPCReg];				\
+    registers[NextPCReg] = pcAfter;					\
+    if (++blockLength >= blockLimit || !FetchInstruction(instr))	\
+	return;								\
+    nextLoadReg = nextLoadValue = 0;					\
+    pcAfter = registers[NextPCReg] + 4;					\
+    goto *instr->handler
+#else
+#define OPCODE(op)	case op:
+#define NEXT		break
+#endif
+
 //----------------------------------------------------------------------
 // Machine::Run
 // 	Simulate the execution of a user-level program on Nachos.
@@ -37,13 +77,63 @@ Machine::Run()
 	       currentThread->getName(), stats->totalTicks);
     interrupt->setStatus(UserMode);
     for (;;) {
-        OneInstruction(instr);
+	// batch up the ticks that can't fire anything, unless someone
+	// wants to watch every tick
+	if (singleStep || DebugIsEnabled('i') || !RunBlock(instr))
+	    OneInstruction(instr);
 	interrupt->OneTick();
 	if (singleStep && (runUntilTime <= stats->totalTicks))
 	  Debugger();
     }
 }
 
+//----------------------------------------------------------------------
+// Machine::RunBlock
+// 	Run user instructions without calling OneTick after each one,
+//	for as long as nobody could tell the difference: until just before
+//	the next pending interrupt becomes due, or until an instruction
+//	traps to the kernel.  The ticks of the block are charged in one
+//	step when it ends (RaiseException charges them before a trap, so
+//	the kernel sees the same time it would have).  The instruction
+//	that reaches the deadline, or that trapped, is ticked by the
+//	caller with OneTick as usual.
+//
+//	Nothing else advances time or looks at it while a user instruction
+//	runs, so timer and device interrupts fire on exactly the same tick
+//	as in the one-tick-per-instruction loop.
+//
+//	Returns TRUE if the block ended in a trap, i.e. its last
+//	instruction has been run already and only needs its tick.
+//----------------------------------------------------------------------
+
+bool
+Machine::RunBlock(Instruction *instr)
+{
+    int quiet = interrupt->QuietTicks() / UserTick;
+
+    blockLength = 0;
+    trapped = FALSE;
+#ifdef THREADED_DISPATCH
+    if (quiet > 0 && !DebugIsEnabled('a') && !DebugIsEnabled('m')) {
+	blockLimit = quiet;	// OneInstruction runs the whole block
+	OneInstruction(instr);
+	blockLimit = 0;
+	if (trapped)
+	    return TRUE;
+    }
+#endif
+    while (blockLength < quiet) {
+	OneInstruction(instr);
+	if (trapped)
+	    return TRUE;	// the rest is already charged
+	blockLength++;
+    }
+    stats->totalTicks += blockLength * UserTick;
+    stats->userTicks += blockLength * UserTick;
+    blockLength = 0;
+    return FALSE;
+}
+
 
 //----------------------------------------------------------------------
 // TypeToReg
@@ -98,11 +188,44 @@ Machine::OneInstruction(Instruction *instr)
     int nextLoadValue = 0; 	// record delayed load operation, to apply
 				// in the future
 
+#ifdef THREADED_DISPATCH
+    if (handlerTable == NULL) {	// first call: publish the handlers
+	static void *table[MaxOpcode + 1];
+
+	for (int i = 0; i <= MaxOpcode; i++)
+	    table[i] = &&do_default;
+	HANDLER(OP_ADD); HANDLER(OP_ADDI); HANDLER(OP_ADDIU);
+	HANDLER(OP_ADDU); HANDLER(OP_AND); HANDLER(OP_ANDI);
+	HANDLER(OP_BEQ); HANDLER(OP_BGEZAL); HANDLER(OP_BGEZ);
+	HANDLER(OP_BGTZ); HANDLER(OP_BLEZ); HANDLER(OP_BLTZAL);
+	HANDLER(OP_BLTZ); HANDLER(OP_BNE); HANDLER(OP_DIV);
+	HANDLER(OP_DIVU); HANDLER(OP_JAL); HANDLER(OP_J);
+	HANDLER(OP_JALR); HANDLER(OP_JR); HANDLER(OP_LB);
+	HANDLER(OP_LBU); HANDLER(OP_LH); HANDLER(OP_LHU);
+	HANDLER(OP_LUI); HANDLER(OP_LW); HANDLER(OP_LWL);
+	HANDLER(OP_LWR); HANDLER(OP_MFHI); HANDLER(OP_MFLO);
+	HANDLER(OP_MTHI); HANDLER(OP_MTLO); HANDLER(OP_MULT);
+	HANDLER(OP_MULTU); HANDLER(OP_NOR); HANDLER(OP_OR);
+	HANDLER(OP_ORI); HANDLER(OP_SB); HANDLER(OP_SH);
+	HANDLER(OP_SLL); HANDLER(OP_SLLV); HANDLER(OP_SLT);
+	HANDLER(OP_SLTI); HANDLER(OP_SLTIU); HANDLER(OP_SLTU);
+	HANDLER(OP_SRA); HANDLER(OP_SRAV); HANDLER(OP_SRL);
+	HANDLER(OP_SRLV); HANDLER(OP_SUB); HANDLER(OP_SUBU);
+	HANDLER(OP_SW); HANDLER(OP_SWL); HANDLER(OP_SWR);
+	HANDLER(OP_SYSCALL); HANDLER(OP_XOR); HANDLER(OP_XORI);
+	HANDLER(OP_RES); HANDLER(OP_UNIMP);
+	handlerTable = table;
+    }
+#endif
+
     // Fetch instruction 
-    if (!machine->ReadMem(registers[PCReg], 4, &raw))
+    if (DebugIsEnabled('a')) {	// keep the full address trace
+	if (!machine->ReadMem(registers[PCReg], 4, &raw))
+	    return;		// exception occurred
+	instr->value = raw;
+	instr->Decode();
+    } else if (!FetchInstruction(instr))
 	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
 
     if (DebugIsEnabled('m')) {
        struct OpString *str = &opStrings[instr->opCode];
@@ -120,9 +243,13 @@ Machine::OneInstruction(Instruction *instr)
     unsigned int rs, rt, imm;
 
     // Execute the instruction (cf. Kane's book)
+#ifdef THREADED_DISPATCH
+    if (blockLimit > 0)
+	goto *instr->handler;
+#endif
     switch (instr->opCode) {
 	
-      case OP_ADD:
+      OPCODE(OP_ADD)
 	sum = registers[instr->rs] + registers[instr->rt];
 	if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ sum) & SIGN_BIT)) {
@@ -130,9 +257,9 @@ Machine::OneInstruction(Instruction *instr)
 	    return;
 	}
 	registers[instr->rd] = sum;
-	break;
+	NEXT;
 	
-      case OP_ADDI:
+      OPCODE(OP_ADDI)
 	sum = registers[instr->rs] + instr->extra;
 	if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
 	    ((instr->extra ^ sum) & SIGN_BIT)) {
@@ -140,59 +267,59 @@ Machine::OneInstruction(Instruction *instr)
 	    return;
 	}
 	registers[instr->rt] = sum;
-	break;
+	NEXT;
 	
-      case OP_ADDIU:
+      OPCODE(OP_ADDIU)
 	registers[instr->rt] = registers[instr->rs] + instr->extra;
-	break;
+	NEXT;
 	
-      case OP_ADDU:
+      OPCODE(OP_ADDU)
 	registers[instr->rd] = registers[instr->rs] + registers[instr->rt];
-	break;
+	NEXT;
 	
-      case OP_AND:
+      OPCODE(OP_AND)
 	registers[instr->rd] = registers[instr->rs] & registers[instr->rt];
-	break;
+	NEXT;
 	
-      case OP_ANDI:
+      OPCODE(OP_ANDI)
 	registers[instr->rt] = registers[instr->rs] & (instr->extra & 0xffff);
-	break;
+	NEXT;
 	
-      case OP_BEQ:
+      OPCODE(OP_BEQ)
 	if (registers[instr->rs] == registers[instr->rt])
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_BGEZAL:
+      OPCODE(OP_BGEZAL)
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_BGEZ:
+      OPCODE(OP_BGEZ)
 	if (!(registers[instr->rs] & SIGN_BIT))
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_BGTZ:
+      OPCODE(OP_BGTZ)
 	if (registers[instr->rs] > 0)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_BLEZ:
+      OPCODE(OP_BLEZ)
 	if (registers[instr->rs] <= 0)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_BLTZAL:
+      OPCODE(OP_BLTZAL)
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_BLTZ:
+      OPCODE(OP_BLTZ)
 	if (registers[instr->rs] & SIGN_BIT)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_BNE:
+      OPCODE(OP_BNE)
 	if (registers[instr->rs] != registers[instr->rt])
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_DIV:
+      OPCODE(OP_DIV)
 	if (registers[instr->rt] == 0) {
 	    registers[LoReg] = 0;
 	    registers[HiReg] = 0;
@@ -200,9 +327,9 @@ Machine::OneInstruction(Instruction *instr)
 	    registers[LoReg] =  registers[instr->rs] / registers[instr->rt];
 	    registers[HiReg] = registers[instr->rs] % registers[instr->rt];
 	}
-	break;
+	NEXT;
 	
-      case OP_DIVU:	  
+      OPCODE(OP_DIVU)
 	  rs = (unsigned int) registers[instr->rs];
 	  rt = (unsigned int) registers[instr->rt];
 	  if (rt == 0) {
@@ -214,22 +341,22 @@ Machine::OneInstruction(Instruction *instr)
 	      tmp = rs % rt;
 	      registers[HiReg] = (int) tmp;
 	  }
-	  break;
+	  NEXT;
 	
-      case OP_JAL:
+      OPCODE(OP_JAL)
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_J:
+      OPCODE(OP_J)
 	pcAfter = (pcAfter & 0xf0000000) | IndexToAddr(instr->extra);
-	break;
+	NEXT;
 	
-      case OP_JALR:
+      OPCODE(OP_JALR)
 	registers[instr->rd] = registers[NextPCReg] + 4;
-      case OP_JR:
+      OPCODE(OP_JR)
 	pcAfter = registers[instr->rs];
-	break;
+	NEXT;
 	
-      case OP_LB:
-      case OP_LBU:
+      OPCODE(OP_LB)
+      OPCODE(OP_LBU)
 	tmp = registers[instr->rs] + instr->extra;
 	if (!machine->ReadMem(tmp, 1, &value))
 	    return;
@@ -240,10 +367,10 @@ Machine::OneInstruction(Instruction *instr)
 	    value &= 0xff;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	NEXT;
 	
-      case OP_LH:
-      case OP_LHU:	  
+      OPCODE(OP_LH)
+      OPCODE(OP_LHU)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x1) {
 	    RaiseException(AddressErrorException, tmp);
@@ -258,14 +385,14 @@ Machine::OneInstruction(Instruction *instr)
 	    value &= 0xffff;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	NEXT;
       	
-      case OP_LUI:
+      OPCODE(OP_LUI)
 	DEBUG('m', "Executing: LUI r%d,%d\n", instr->rt, instr->extra);
 	registers[instr->rt] = instr->extra << 16;
-	break;
+	NEXT;
 	
-      case OP_LW:
+      OPCODE(OP_LW)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x3) {
 	    RaiseException(AddressErrorException, tmp);
@@ -275,9 +402,9 @@ Machine::OneInstruction(Instruction *instr)
 	    return;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	NEXT;
     	
-      case OP_LWL:	  
+      OPCODE(OP_LWL)
 	tmp = registers[instr->rs] + instr->extra;
 
 	// ReadMem assumes all 4 byte requests are aligned on an even 
@@ -306,9 +433,9 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	nextLoadReg = instr->rt;
-	break;
+	NEXT;
       	
-      case OP_LWR:
+      OPCODE(OP_LWR)
 	tmp = registers[instr->rs] + instr->extra;
 
 	// ReadMem assumes all 4 byte requests are aligned on an even 
@@ -340,121 +467,121 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	nextLoadReg = instr->rt;
-	break;
+	NEXT;
     	
-      case OP_MFHI:
+      OPCODE(OP_MFHI)
 	registers[instr->rd] = registers[HiReg];
-	break;
+	NEXT;
 	
-      case OP_MFLO:
+      OPCODE(OP_MFLO)
 	registers[instr->rd] = registers[LoReg];
-	break;
+	NEXT;
 	
-      case OP_MTHI:
+      OPCODE(OP_MTHI)
 	registers[HiReg] = registers[instr->rs];
-	break;
+	NEXT;
 	
-      case OP_MTLO:
+      OPCODE(OP_MTLO)
 	registers[LoReg] = registers[instr->rs];
-	break;
+	NEXT;
 	
-      case OP_MULT:
+      OPCODE(OP_MULT)
 	Mult(registers[instr->rs], registers[instr->rt], TRUE,
 	     &registers[HiReg], &registers[LoReg]);
-	break;
+	NEXT;
 	
-      case OP_MULTU:
+      OPCODE(OP_MULTU)
 	Mult(registers[instr->rs], registers[instr->rt], FALSE,
 	     &registers[HiReg], &registers[LoReg]);
-	break;
+	NEXT;
 	
-      case OP_NOR:
+      OPCODE(OP_NOR)
 	registers[instr->rd] = ~(registers[instr->rs] | registers[instr->rt]);
-	break;
+	NEXT;
 	
-      case OP_OR:
+      OPCODE(OP_OR)
 	registers[instr->rd] = registers[instr->rs] | registers[instr->rs];
-	break;
+	NEXT;
 	
-      case OP_ORI:
+      OPCODE(OP_ORI)
 	registers[instr->rt] = registers[instr->rs] | (instr->extra & 0xffff);
-	break;
+	NEXT;
 	
-      case OP_SB:
+      OPCODE(OP_SB)
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
 	    return;
-	break;
+	NEXT;
 	
-      case OP_SH:
+      OPCODE(OP_SH)
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
 	    return;
-	break;
+	NEXT;
 	
-      case OP_SLL:
+      OPCODE(OP_SLL)
 	registers[instr->rd] = registers[instr->rt] << instr->extra;
-	break;
+	NEXT;
 	
-      case OP_SLLV:
+      OPCODE(OP_SLLV)
 	registers[instr->rd] = registers[instr->rt] <<
 	    (registers[instr->rs] & 0x1f);
-	break;
+	NEXT;
 	
-      case OP_SLT:
+      OPCODE(OP_SLT)
 	if (registers[instr->rs] < registers[instr->rt])
 	    registers[instr->rd] = 1;
 	else
 	    registers[instr->rd] = 0;
-	break;
+	NEXT;
 	
-      case OP_SLTI:
+      OPCODE(OP_SLTI)
 	if (registers[instr->rs] < instr->extra)
 	    registers[instr->rt] = 1;
 	else
 	    registers[instr->rt] = 0;
-	break;
+	NEXT;
 	
-      case OP_SLTIU:	  
+      OPCODE(OP_SLTIU)
 	rs = registers[instr->rs];
 	imm = instr->extra;
 	if (rs < imm)
 	    registers[instr->rt] = 1;
 	else
 	    registers[instr->rt] = 0;
-	break;
+	NEXT;
       	
-      case OP_SLTU:	  
+      OPCODE(OP_SLTU)
 	rs = registers[instr->rs];
 	rt = registers[instr->rt];
 	if (rs < rt)
 	    registers[instr->rd] = 1;
 	else
 	    registers[instr->rd] = 0;
-	break;
+	NEXT;
       	
-      case OP_SRA:
+      OPCODE(OP_SRA)
 	registers[instr->rd] = registers[instr->rt] >> instr->extra;
-	break;
+	NEXT;
 	
-      case OP_SRAV:
+      OPCODE(OP_SRAV)
 	registers[instr->rd] = registers[instr->rt] >>
 	    (registers[instr->rs] & 0x1f);
-	break;
+	NEXT;
 	
-      case OP_SRL:
+      OPCODE(OP_SRL)
 	tmp = registers[instr->rt];
 	tmp >>= instr->extra;
 	registers[instr->rd] = tmp;
-	break;
+	NEXT;
 	
-      case OP_SRLV:
+      OPCODE(OP_SRLV)
 	tmp = registers[instr->rt];
 	tmp >>= (registers[instr->rs] & 0x1f);
 	registers[instr->rd] = tmp;
-	break;
+	NEXT;
 	
-      case OP_SUB:	  
+      OPCODE(OP_SUB)
 	diff = registers[instr->rs] - registers[instr->rt];
 	if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ diff) & SIGN_BIT)) {
@@ -462,19 +589,19 @@ Machine::OneInstruction(Instruction *instr)
 	    return;
 	}
 	registers[instr->rd] = diff;
-	break;
+	NEXT;
       	
-      case OP_SUBU:
+      OPCODE(OP_SUBU)
 	registers[instr->rd] = registers[instr->rs] - registers[instr->rt];
-	break;
+	NEXT;
 	
-      case OP_SW:
+      OPCODE(OP_SW)
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
 	    return;
-	break;
+	NEXT;
 	
-      case OP_SWL:	  
+      OPCODE(OP_SWL)
 	tmp = registers[instr->rs] + instr->extra;
 
 	// The little endian/big endian swap code would
@@ -502,9 +629,9 @@ Machine::OneInstruction(Instruction *instr)
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
 	    return;
-	break;
+	NEXT;
     	
-      case OP_SWR:	  
+      OPCODE(OP_SWR)
 	tmp = registers[instr->rs] + instr->extra;
 
 	// The little endian/big endian swap code would
@@ -529,26 +656,29 @@ Machine::OneInstruction(Instruction *instr)
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
 	    return;
-	break;
+	NEXT;
     	
-      case OP_SYSCALL:
+      OPCODE(OP_SYSCALL)
 	RaiseException(SyscallException, 0);
 	return; 
 	
-      case OP_XOR:
+      OPCODE(OP_XOR)
 	registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
-	break;
+	NEXT;
 	
-      case OP_XORI:
+      OPCODE(OP_XORI)
 	registers[instr->rt] = registers[instr->rs] ^ (instr->extra & 0xffff);
-	break;
+	NEXT;
 	
-      case OP_RES:
-      case OP_UNIMP:
+      OPCODE(OP_RES)
+      OPCODE(OP_UNIMP)
 	RaiseException(IllegalInstrException, 0);
 	return;
 	
       default:
+#ifdef THREADED_DISPATCH
+      do_default:
+#endif
 	ASSERT(FALSE);
     }
     
@@ -581,6 +711,52 @@ Machine::DelayedLoad(int nextReg, int nextValue)
     registers[0] = 0; 	// and always make sure R0 stays zero.
 }
 
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Fetch the instruction at PC into "instr", already decoded.
+//
+//	Every word of physical memory has a slot in decodeCache, filled
+//	the first time the word is executed and cleared whenever it is
+//	written (WriteMem) or its frame is refilled (InvalidateDecoded).
+//	The PC is translated through the translation cache, so a loop
+//	normally goes through neither Translate nor Decode.
+//
+//	Returns FALSE if the fetch raised an exception.
+//----------------------------------------------------------------------
+
+bool
+Machine::FetchInstruction(Instruction *instr)
+{
+    int pc = registers[PCReg];
+    ExceptionType exception;
+    int physAddr, word;
+    char *host = FastTranslate(pc, 4, FALSE);
+
+    if (host != NULL)
+	physAddr = host - mainMemory;
+    else {
+	exception = Translate(pc, &physAddr, 4, FALSE);
+	if (exception != NoException) {
+	    RaiseException(exception, pc);
+	    return FALSE;
+	}
+	CacheTranslation(pc);
+    }
+
+    word = physAddr / 4;
+    if (!decodeValid[word]) {
+	decodeCache[word].value =
+	    WordToHost(*(unsigned int *) &mainMemory[physAddr]);
+	decodeCache[word].Decode();
+#ifdef THREADED_DISPATCH
+	decodeCache[word].handler = handlerTable[decodeCache[word].opCode];
+#endif
+	decodeValid[word] = TRUE;
+    }
+    *instr = decodeCache[word];
+    return TRUE;
+}
+
 //----------------------------------------------------------------------
 // Instruction::Decode
 // 	Decode a MIPS instruction 
@@ -49,12 +49,11 @@ class Statistics {
 //
 // Since Nachos kernel code is directly executed, and the time spent
 // in the kernel measured by the number of calls to enable interrupts,
-// these time constants are none too exact.
+// these time constants are none too exact.  The disk's timing can be
+// set at startup, and so is kept with its geometry (cf. disk.h).
 
 #define UserTick 1        // advance for each user-level instruction
 #define SystemTick 10     // advance each time interrupts are enabled
-#define RotationTime 500  // time disk takes to rotate one sector
-#define SeekTime 500      // time disk takes to seek past one track
 #define ConsoleTime 100   // time to read or write one character
 #define NetworkTime 100   // time to send or receive one packet
 #define TimerTicks 100    // (average) time between timer interrupts
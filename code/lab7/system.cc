@@ -19,6 +19,7 @@ Interrupt *interrupt;         // interrupt status
 Statistics *stats;            // performance metrics
 Timer *timer;                 // the hardware timer device,
                               // for invoking context switches
+bool mlfqScheduling = FALSE;  // multilevel feedback queue (-mlfq)
 
 #ifdef FILESYS_NEEDED
 FileSystem *fileSystem;
@@ -30,6 +31,13 @@ SynchDisk *synchDisk;
 
 #ifdef USER_PROGRAM  // requires either FILESYS or FILESYS_STUB
 Machine *machine;    // user program memory and registers
+bool checksumOnHalt = FALSE;  // print the user state checksum at halt
+int pageShift;                // log2 of the page size, set below
+int numPhysPages = DefaultPhysPages;  // size of physical memory, in pages
+int tlbSize = DefaultTLBSize;         // entries in the TLB
+int frameQuota = DefaultFrameQuota;   // most frames one program may hold
+bool globalReplacement = FALSE;       // replace across programs (-gr)
+int pffInterval = 0;                  // page fault frequency control (-pff)
 #endif
 
 #ifdef NETWORK
@@ -52,13 +60,15 @@ extern void Cleanup();
 //	which is what we wanted to context switch), we set a flag
 //	so that once the interrupt handler is done, it will appear as
 //	if the interrupted thread called Yield at the point it is
-//	was interrupted.
+//	was interrupted.  The scheduler decides whether to switch:
+//	round robin switches on every timer interrupt.
 //
 //	"dummy" is because every interrupt handler takes one argument,
 //		whether it needs it or not.
 //----------------------------------------------------------------------
 static void TimerInterruptHandler(_int dummy) {
-    if (interrupt->getStatus() != IdleMode) interrupt->YieldOnReturn();
+    if (interrupt->getStatus() != IdleMode && scheduler->SliceExpired())
+        interrupt->YieldOnReturn();
 }
 
 //----------------------------------------------------------------------
@@ -78,6 +88,7 @@ void Initialize(int argc, char **argv) {
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;  // single step user program
+    int pageSize = DefaultPageSize;  // bytes per page
     // lab6----------------------------------
     // 将进程标识符数组进行初始化
     bzero(ThreadMap, 128);
@@ -106,9 +117,42 @@ void Initialize(int argc, char **argv) {
                                             // number generator
             randomYield = TRUE;
             argCount = 2;
+        } else if (!strcmp(*argv, "-mlfq")) {
+            mlfqScheduling = TRUE;  // needs the timer
+        } else if (!strcmp(*argv, "-sp")) {
+            ASSERT(argc > 1);
+            stackPoolLimit = atoi(*(argv + 1));  // thread stacks kept
+            argCount = 2;
         }
 #ifdef USER_PROGRAM
-        if (!strcmp(*argv, "-s")) debugUserProg = TRUE;
+        if (!strcmp(*argv, "-s")) {
+            debugUserProg = TRUE;
+        } else if (!strcmp(*argv, "-cs")) {
+            checksumOnHalt = TRUE;
+        } else if (!strcmp(*argv, "-ps")) {  // page size, in bytes
+            ASSERT(argc > 1);
+            pageSize = atoi(*(argv + 1));
+            argCount = 2;
+        } else if (!strcmp(*argv, "-np")) {  // physical memory size
+            ASSERT(argc > 1);
+            numPhysPages = atoi(*(argv + 1));
+            argCount = 2;
+        } else if (!strcmp(*argv, "-tlb")) {  // TLB size
+            ASSERT(argc > 1);
+            tlbSize = atoi(*(argv + 1));
+            argCount = 2;
+        } else if (!strcmp(*argv, "-mf")) {  // frames per user program
+            ASSERT(argc > 1);
+            frameQuota = atoi(*(argv + 1));
+            argCount = 2;
+        } else if (!strcmp(*argv, "-gr")) {  // global page replacement
+            globalReplacement = TRUE;
+        } else if (!strcmp(*argv, "-pff")) {  // ticks between page faults
+            ASSERT(argc > 1);
+            pffInterval = atoi(*(argv + 1));
+            ASSERT(pffInterval >= 0);
+            argCount = 2;
+        }
 #endif
 #ifdef FILESYS_NEEDED
         if (!strcmp(*argv, "-f")) format = TRUE;
@@ -134,7 +178,7 @@ void Initialize(int argc, char **argv) {
     stats = new Statistics();     // collect statistics
     interrupt = new Interrupt;    // start up interrupt handling
     scheduler = new Scheduler();  // initialize the ready queue
-    if (randomYield)              // start the timer (if needed)
+    if (randomYield || mlfqScheduling)  // start the timer (if needed)
         timer = new Timer(TimerInterruptHandler, 0, randomYield);
 
     threadToBeDestroyed = NULL;
@@ -149,6 +193,12 @@ void Initialize(int argc, char **argv) {
     CallOnUserAbort(Cleanup);  // if user hits ctl-C
 
 #ifdef USER_PROGRAM
+    // a power of two, and a whole number of sectors
+    for (pageShift = 0; (1 << pageShift) < pageSize; pageShift++)
+        ;
+    ASSERT(PageSize == pageSize && pageSize % SectorSize == 0);
+    ASSERT(numPhysPages > 0 && tlbSize > 0);
+    ASSERT(frameQuota > 0 && frameQuota <= numPhysPages);
     machine = new Machine(debugUserProg);  // this must come first
 
 #endif
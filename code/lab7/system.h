@@ -31,10 +31,13 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+extern bool mlfqScheduling;			// multilevel feedback queue
+						// scheduling (-mlfq)
 
 #ifdef USER_PROGRAM
 #include "machine.h"
 extern Machine* machine;	// user program memory and registers
+extern bool checksumOnHalt;	// print Machine::Checksum() at halt (-cs)
 #endif
 
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
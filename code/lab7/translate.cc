@@ -92,27 +92,32 @@ bool Machine::ReadMem(int addr, int size, int *value) {
     int data;
     ExceptionType exception;
     int physicalAddress;
+    char *host;
 
-    DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
+    if (traceMemory || (host = FastTranslate(addr, size, FALSE)) == NULL) {
+        DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
 
-    exception = Translate(addr, &physicalAddress, size, FALSE);
-    if (exception != NoException) {
-        machine->RaiseException(exception, addr);
-        return FALSE;
+        exception = Translate(addr, &physicalAddress, size, FALSE);
+        if (exception != NoException) {
+            machine->RaiseException(exception, addr);
+            return FALSE;
+        }
+        CacheTranslation(addr);
+        host = &mainMemory[physicalAddress];
     }
     switch (size) {
         case 1:
-            data = machine->mainMemory[physicalAddress];
+            data = *host;
             *value = data;
             break;
 
         case 2:
-            data = *(unsigned short *)&machine->mainMemory[physicalAddress];
+            data = *(unsigned short *)host;
             *value = ShortToHost(data);
             break;
 
         case 4:
-            data = *(unsigned int *)&machine->mainMemory[physicalAddress];
+            data = *(unsigned int *)host;
             *value = WordToHost(data);
             break;
 
@@ -140,37 +145,89 @@ bool Machine::ReadMem(int addr, int size, int *value) {
 bool Machine::WriteMem(int addr, int size, int value) {
     ExceptionType exception;
     int physicalAddress;
+    char *host;
 
-    DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
+    if (traceMemory || (host = FastTranslate(addr, size, TRUE)) == NULL) {
+        DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size,
+              value);
 
-    exception = Translate(addr, &physicalAddress, size, TRUE);
-    if (exception != NoException) {
-        machine->RaiseException(exception, addr);
-        return FALSE;
+        exception = Translate(addr, &physicalAddress, size, TRUE);
+        if (exception != NoException) {
+            machine->RaiseException(exception, addr);
+            return FALSE;
+        }
+        CacheTranslation(addr);
+        host = &mainMemory[physicalAddress];
     }
     switch (size) {
         case 1:
-            machine->mainMemory[physicalAddress] =
-                (unsigned char)(value & 0xff);
+            *host = (unsigned char)(value & 0xff);
             break;
 
         case 2:
-            *(unsigned short *)&machine->mainMemory[physicalAddress] =
+            *(unsigned short *)host =
                 ShortToMachine((unsigned short)(value & 0xffff));
             break;
 
         case 4:
-            *(unsigned int *)&machine->mainMemory[physicalAddress] =
-                WordToMachine((unsigned int)value);
+            *(unsigned int *)host = WordToMachine((unsigned int)value);
             break;
 
         default:
             ASSERT(FALSE);
     }
+    decodeValid[(host - mainMemory) / 4] = FALSE;  // may have been code
 
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// Machine::FastTranslate
+// 	Look a virtual address up in the host-side translation cache, a
+//	direct-mapped table (indexed by virtual page number) of the
+//	translations Translate has found recently.  On a hit, return a
+//	pointer to the addressed byte in mainMemory, setting the use/dirty
+//	bits exactly as Translate would; on a miss, or if Translate would
+//	raise an exception (misaligned access, write to a read-only page),
+//	return NULL and let the caller go the slow way.
+//
+//	The cache is only valid as long as the mappings it was filled from
+//	are: see FlushTranslations.
+//
+//	"virtAddr" -- the virtual address to translate
+//	"size" -- the amount of memory being read or written
+// 	"writing" -- if TRUE, check the "read-only" bit and set "dirty"
+//----------------------------------------------------------------------
+
+char *Machine::FastTranslate(int virtAddr, int size, bool writing) {
+    unsigned int vpn = PageNumber(virtAddr);
+    CachedTranslation *slot =
+        &translationCache[vpn & (TranslationCacheSize - 1)];
+
+    if (slot->vpn != (int)vpn || (virtAddr & (size - 1)) ||
+        (writing && slot->entry->readOnly))
+        return NULL;
+    slot->entry->use = TRUE;
+    if (writing) slot->entry->dirty = TRUE;
+    return slot->page + PageOffset(virtAddr);
+}
+
+//----------------------------------------------------------------------
+// Machine::CacheTranslation
+// 	Enter the translation the last successful call to Translate
+//	found, for the page holding "virtAddr", into the translation cache.
+//----------------------------------------------------------------------
+
+void Machine::CacheTranslation(int virtAddr) {
+    unsigned int vpn = PageNumber(virtAddr);
+    CachedTranslation *slot =
+        &translationCache[vpn & (TranslationCacheSize - 1)];
+
+    slot->vpn = vpn;
+    slot->entry = lastEntry;
+    slot->page = &mainMemory[lastEntry->physicalPage * PageSize];
+}
+
 //----------------------------------------------------------------------
 // Machine::Translate
 // 	Translate a virtual address into a physical address, using
@@ -208,8 +265,8 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
 
     // calculate the virtual page number, and offset within the page,
     // from the virtual address
-    vpn = (unsigned)virtAddr / PageSize;
-    offset = (unsigned)virtAddr % PageSize;
+    vpn = PageNumber(virtAddr);
+    offset = PageOffset(virtAddr);
 
     if (tlb == NULL) {  // => page table => vpn is index into table
         if (vpn >= pageTableSize) {
@@ -223,7 +280,7 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
         }
         entry = &pageTable[vpn];
     } else {
-        for (entry = NULL, i = 0; i < TLBSize; i++)
+        for (entry = NULL, i = 0; i < tlbSize; i++)
             if (tlb[i].valid && ((unsigned int)tlb[i].virtualPage == vpn)) {
                 entry = &tlb[i];  // FOUND!
                 break;
@@ -244,13 +301,14 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
-    if (pageFrame >= NumPhysPages) {
-        DEBUG('a', "*** frame %d > %d!\n", pageFrame, NumPhysPages);
+    if (pageFrame >= (unsigned)numPhysPages) {
+        DEBUG('a', "*** frame %d > %d!\n", pageFrame, numPhysPages);
         return BusErrorException;
     }
     entry->use = TRUE;  // set the use, dirty bits
     if (writing) entry->dirty = TRUE;
     *physAddr = pageFrame * PageSize + offset;
+    lastEntry = entry;
     ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
     return NoException;
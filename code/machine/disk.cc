@@ -25,6 +25,17 @@
 
 #define DiskSize 	(MagicSize + (NumSectors * SectorSize))
 
+int sectorsPerTrack = 32;
+int numTracks = 32;
+int rotationTime = 500;
+int seekTime = 500;
+
+DiskBackend diskBackend = DiskFile;
+const char* diskBackendNames[] = {"file", "mmap", "msync"};
+
+DiskLatency diskLatency = TrackBufferLatency;
+const char* diskLatencyNames[] = {"track", "ssd", "zoned"};
+
 // dummy procedure because we can't take a pointer of a member function
 static void DiskDone(_int arg) { ((Disk *)arg)->HandleInterrupt(); }
 
@@ -32,7 +43,9 @@ static void DiskDone(_int arg) { ((Disk *)arg)->HandleInterrupt(); }
 // Disk::Disk()
 // 	Initialize a simulated disk.  Open the UNIX file (creating it
 //	if it doesn't exist), and check the magic number to make sure it's 
-// 	ok to treat it as Nachos disk storage.
+// 	ok to treat it as Nachos disk storage, and that it is the size
+//	the geometry says.  Map the file into memory, unless "diskBackend"
+//	says not to.
 //
 //	"name" -- text name of the file simulating the Nachos disk
 //	"callWhenDone" -- interrupt handler to be called when disk read/write
@@ -48,13 +61,14 @@ Disk::Disk(const char* name, VoidFunctionPtr callWhenDone, _int callArg)
     DEBUG('d', "Initializing the disk, 0x%x 0x%x\n", callWhenDone, callArg);
     handler = callWhenDone;
     handlerArg = callArg;
-    lastSector = 0;
-    bufferInit = 0;
+    model = DiskModel::Create(diskLatency);
     
     fileno = OpenForReadWrite((char*)name, FALSE);
     if (fileno >= 0) {		 	// file exists, check magic number 
 	Read(fileno, (char *) &magicNum, MagicSize);
 	ASSERT(magicNum == MagicNumber);
+	Lseek(fileno, 0, 2);		// and that it has the same geometry
+	ASSERT(Tell(fileno) == (int) DiskSize);
     } else {				// file doesn't exist, create it
         fileno = OpenForWrite((char*)name);
 	magicNum = MagicNumber;  
@@ -64,18 +78,41 @@ Disk::Disk(const char* name, VoidFunctionPtr callWhenDone, _int callArg)
         Lseek(fileno, DiskSize - sizeof(int), 0);	
 	WriteFile(fileno, (char *)&tmp, sizeof(int));  
     }
+    image = NULL;
+    syncOnBarrier = (bool)(diskBackend == DiskMapSync);
+    if (diskBackend != DiskFile)
+	image = MapFile(fileno, DiskSize);
     active = FALSE;
 }
 
 //----------------------------------------------------------------------
 // Disk::~Disk()
 // 	Clean up disk simulation, by closing the UNIX file representing the
-//	disk.
+//	disk (once a mapped file is up to date).
 //----------------------------------------------------------------------
 
 Disk::~Disk()
 {
+    if (image != NULL) {
+	SyncMappedFile(image, DiskSize);
+	UnmapFile(image, DiskSize);
+    }
     Close(fileno);
+    delete model;
+}
+
+//----------------------------------------------------------------------
+// Disk::Sync()
+// 	A barrier: with the DiskMapSync backend, wait until everything
+//	written to the disk so far has reached the UNIX file on disk.
+//	The other backends leave that to the host.
+//----------------------------------------------------------------------
+
+void
+Disk::Sync()
+{
+    if (image != NULL && syncOnBarrier)
+	SyncMappedFile(image, DiskSize);
 }
 
 //----------------------------------------------------------------------
@@ -115,39 +152,78 @@ PrintSector (bool writing, int sector, char *data)
 void
 Disk::ReadRequest(int sectorNumber, char* data)
 {
-    int ticks = ComputeLatency(sectorNumber, FALSE);
+    ReadRun(sectorNumber, 1, data);
+}
+
+void
+Disk::WriteRequest(int sectorNumber, char* data)
+{
+    WriteRun(sectorNumber, 1, data);
+}
+
+//----------------------------------------------------------------------
+// Disk::ReadRun/WriteRun
+// 	Simulate a request to read/write "numSectors" consecutive disk
+//	sectors, starting at "sectorNumber", as for ReadRequest/WriteRequest.
+//	The sectors are transferred one after another as they pass under
+//	the head, and there is one interrupt, when the last one is done.
+//
+//	"data" -- the bytes to be written, the buffer to hold the incoming
+//	   bytes; numSectors * SectorSize of them
+//----------------------------------------------------------------------
+
+void
+Disk::ReadRun(int sectorNumber, int numSectors, char* data)
+{
+    int ticks;
 
     ASSERT(!active);				// only one request at a time
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
+    ASSERT((sectorNumber >= 0) && (numSectors > 0)
+		&& (sectorNumber + numSectors <= NumSectors));
     
-    DEBUG('d', "Reading from sector %d\n", sectorNumber);
-    Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    Read(fileno, data, SectorSize);
+    DEBUG('d', "Reading %d sector(s) from sector %d\n", numSectors,
+		sectorNumber);
+    if (image != NULL)
+	bcopy(&image[SectorSize * sectorNumber + MagicSize], data,
+	      numSectors * SectorSize);
+    else {
+	Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
+	Read(fileno, data, numSectors * SectorSize);
+    }
     if (DebugIsEnabled('d'))
-	PrintSector(FALSE, sectorNumber, data);
+	for (int i = 0; i < numSectors; i++)
+	    PrintSector(FALSE, sectorNumber + i, &data[i * SectorSize]);
     
     active = TRUE;
-    UpdateLast(sectorNumber);
+    ticks = model->Latency(sectorNumber, numSectors, FALSE);
     stats->numDiskReads++;
     interrupt->Schedule(DiskDone, (_int) this, ticks, DiskInt);
 }
 
 void
-Disk::WriteRequest(int sectorNumber, char* data)
+Disk::WriteRun(int sectorNumber, int numSectors, char* data)
 {
-    int ticks = ComputeLatency(sectorNumber, TRUE);
+    int ticks;
 
     ASSERT(!active);
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
+    ASSERT((sectorNumber >= 0) && (numSectors > 0)
+		&& (sectorNumber + numSectors <= NumSectors));
     
-    DEBUG('d', "Writing to sector %d\n", sectorNumber);
-    Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    WriteFile(fileno, data, SectorSize);
+    DEBUG('d', "Writing %d sector(s) to sector %d\n", numSectors,
+		sectorNumber);
+    if (image != NULL)
+	bcopy(data, &image[SectorSize * sectorNumber + MagicSize],
+	      numSectors * SectorSize);
+    else {
+	Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
+	WriteFile(fileno, data, numSectors * SectorSize);
+    }
     if (DebugIsEnabled('d'))
-	PrintSector(TRUE, sectorNumber, data);
+	for (int i = 0; i < numSectors; i++)
+	    PrintSector(TRUE, sectorNumber + i, &data[i * SectorSize]);
     
     active = TRUE;
-    UpdateLast(sectorNumber);
+    ticks = model->Latency(sectorNumber, numSectors, TRUE);
     stats->numDiskWrites++;
     interrupt->Schedule(DiskDone, (_int) this, ticks, DiskInt);
 }
@@ -166,7 +242,57 @@ Disk::HandleInterrupt ()
 }
 
 //----------------------------------------------------------------------
-// Disk::TimeToSeek()
+// DiskModel::Create
+// 	Return a new latency model of the given kind, for a Disk to use.
+//----------------------------------------------------------------------
+
+DiskModel *
+DiskModel::Create(DiskLatency kind)
+{
+    switch (kind) {
+      case ConstantLatency:
+	return new ConstantModel();
+      case ZonedLatency:
+	return new ZonedModel();
+      default:
+	return new TrackBufferModel();
+    }
+}
+
+//----------------------------------------------------------------------
+// TrackBufferModel::TrackBufferModel
+// 	Start with the head over sector 0, and nothing in the track buffer.
+//----------------------------------------------------------------------
+
+TrackBufferModel::TrackBufferModel()
+{
+    lastSector = 0;
+    bufferInit = 0;
+}
+
+//----------------------------------------------------------------------
+// TrackBufferModel::Latency
+// 	Return how long a request for "numSectors" sectors starting at
+//	"sectorNumber" takes: the latency of the first sector, then the
+//	time for the rest of the run.  Also count the tracks the head
+//	moves across, to the first sector and then along the run.
+//----------------------------------------------------------------------
+
+int
+TrackBufferModel::Latency(int sectorNumber, int numSectors, bool writing)
+{
+    int ticks = ComputeLatency(sectorNumber, writing);
+    int first = sectorNumber / SectorsPerTrack;
+
+    stats->numDiskSeeks += abs(first - lastSector / SectorsPerTrack)
+	+ (sectorNumber + numSectors - 1) / SectorsPerTrack - first;
+
+    UpdateLast(sectorNumber);
+    return ticks + RunLatency(sectorNumber, numSectors, ticks);
+}
+
+//----------------------------------------------------------------------
+// TrackBufferModel::TimeToSeek()
 //	Returns how long it will take to position the disk head over the correct
 //	track on the disk.  Since when we finish seeking, we are likely
 //	to be in the middle of a sector that is rotating past the head,
@@ -177,7 +303,7 @@ Disk::HandleInterrupt ()
 //----------------------------------------------------------------------
 
 int
-Disk::TimeToSeek(int newSector, int *rotation) 
+TrackBufferModel::TimeToSeek(int newSector, int *rotation) 
 {
     int newTrack = newSector / SectorsPerTrack;
     int oldTrack = lastSector / SectorsPerTrack;
@@ -194,13 +320,13 @@ Disk::TimeToSeek(int newSector, int *rotation)
 }
 
 //----------------------------------------------------------------------
-// Disk::ModuloDiff()
+// TrackBufferModel::ModuloDiff()
 // 	Return number of sectors of rotational delay between target sector
 //	"to" and current sector position "from"
 //----------------------------------------------------------------------
 
 int 
-Disk::ModuloDiff(int to, int from)
+TrackBufferModel::ModuloDiff(int to, int from)
 {
     int toOffset = to % SectorsPerTrack;
     int fromOffset = from % SectorsPerTrack;
@@ -209,7 +335,7 @@ Disk::ModuloDiff(int to, int from)
 }
 
 //----------------------------------------------------------------------
-// Disk::ComputeLatency()
+// TrackBufferModel::ComputeLatency()
 // 	Return how long will it take to read/write a disk sector, from
 //	the current position of the disk head.
 //
@@ -230,7 +356,7 @@ Disk::ModuloDiff(int to, int from)
 //----------------------------------------------------------------------
 
 int
-Disk::ComputeLatency(int newSector, bool writing)
+TrackBufferModel::ComputeLatency(int newSector, bool writing)
 {
     int rotation;
     int seek = TimeToSeek(newSector, &rotation);
@@ -253,13 +379,13 @@ Disk::ComputeLatency(int newSector, bool writing)
 }
 
 //----------------------------------------------------------------------
-// Disk::UpdateLast
+// TrackBufferModel::UpdateLast
 //   	Keep track of the most recently requested sector.  So we can know
 //	what is in the track buffer.
 //----------------------------------------------------------------------
 
 void
-Disk::UpdateLast(int newSector)
+TrackBufferModel::UpdateLast(int newSector)
 {
     int rotate;
     int seek = TimeToSeek(newSector, &rotate);
@@ -269,3 +395,121 @@ Disk::UpdateLast(int newSector)
     lastSector = newSector;
     DEBUG('d', "Updating last sector = %d, %d\n", lastSector, bufferInit);
 }
+
+//----------------------------------------------------------------------
+// TrackBufferModel::RunLatency
+//   	Return how much longer a request takes for the sectors after the
+//	first in a run of "numSectors" starting at "sectorNumber", given
+//	that the first is done "ticks" from now.  Sectors on the same
+//	track follow one another under the head, one per RotationTime;
+//	going on to the next track costs a one track seek, and then
+//	waiting for its first sector to come round.
+//
+//	Called after UpdateLast for the first sector; we move the head
+//	(and the track buffer) on to the last.
+//----------------------------------------------------------------------
+
+int
+TrackBufferModel::RunLatency(int sectorNumber, int numSectors, int ticks)
+{
+    int extra = 0;
+
+    for (int s = sectorNumber + 1; s < sectorNumber + numSectors; s++) {
+	if (s % SectorsPerTrack == 0) {		// on to the next track
+	    int when = stats->totalTicks + ticks + extra + SeekTime;
+	    int over = when % RotationTime;
+
+	    extra += SeekTime;
+	    if (over > 0) {			// round up to a sector boundary
+		extra += RotationTime - over;
+		when += RotationTime - over;
+	    }
+	    bufferInit = when;
+	    extra += ModuloDiff(s, when / RotationTime) * RotationTime;
+	}
+	extra += RotationTime;
+    }
+    lastSector = sectorNumber + numSectors - 1;
+    return extra;
+}
+
+//----------------------------------------------------------------------
+// ConstantModel::Latency
+// 	Return how long a request takes on a device with no head to move:
+//	SeekTime to start it, and RotationTime for each sector.
+//----------------------------------------------------------------------
+
+int
+ConstantModel::Latency(int sectorNumber, int numSectors, bool writing)
+{
+    DEBUG('d', "Request latency = %d\n", SeekTime + numSectors * RotationTime);
+    return SeekTime + numSectors * RotationTime;
+}
+
+//----------------------------------------------------------------------
+// ZonedModel::ZonedModel
+// 	Start with the head over the outermost track.
+//----------------------------------------------------------------------
+
+ZonedModel::ZonedModel()
+{
+    headTrack = 0;
+}
+
+//----------------------------------------------------------------------
+// ZonedModel::Locate
+// 	Find where "sector" is: its "track", its "offset" within the
+//	track, and how many sectors that track holds ("perTrack").
+//	Each zone has NumSectors / NumZones of the sectors, the last one
+//	any left over; the last track of a zone may be partly unused.
+//----------------------------------------------------------------------
+
+void
+ZonedModel::Locate(int sector, int *track, int *offset, int *perTrack)
+{
+    int zoneSectors = NumSectors / NumZones;
+    int first = 0;			// first track of the zone
+    int z;
+
+    for (z = 0; z < NumZones - 1 && sector >= zoneSectors; z++) {
+	first += divRoundUp(zoneSectors, 
+			SectorsPerTrack * (3 * NumZones / 2 - z) / NumZones);
+	sector -= zoneSectors;
+    }
+    *perTrack = SectorsPerTrack * (3 * NumZones / 2 - z) / NumZones;
+    if (*perTrack < 1)
+	*perTrack = 1;
+    *track = first + sector / *perTrack;
+    *offset = sector % *perTrack;
+}
+
+//----------------------------------------------------------------------
+// ZonedModel::Latency
+// 	Return how long a request takes: for each sector in turn, seek
+//	to its track if the head is not already there, wait for the
+//	sector to come round, and transfer it while it passes under
+//	the head.  Consecutive sectors on a track follow one another
+//	without a wait.  Also count the tracks the head moves across.
+//----------------------------------------------------------------------
+
+int
+ZonedModel::Latency(int sectorNumber, int numSectors, bool writing)
+{
+    int revolution = SectorsPerTrack * RotationTime;
+    int when = stats->totalTicks;
+    int track, offset, perTrack, start, end;
+
+    for (int s = sectorNumber; s < sectorNumber + numSectors; s++) {
+	Locate(s, &track, &offset, &perTrack);
+	when += abs(track - headTrack) * SeekTime;
+	stats->numDiskSeeks += abs(track - headTrack);
+	headTrack = track;
+	start = offset * revolution / perTrack;	// where the sector begins
+	end = (offset + 1) * revolution / perTrack;	//  and ends, in ticks
+						//  into a revolution
+	when += (start - when % revolution + revolution) % revolution;
+	when += end - start;
+    }
+    DEBUG('d', "Request latency = %d\n", when - stats->totalTicks);
+    return when - stats->totalTicks;
+}
@@ -45,12 +45,124 @@
 // disks these days now come with a track buffer.
 //
 // The track buffer simulation can be disabled by compiling with -DNOTRACKBUF
+//
+// How long a request takes is worked out by a DiskModel, chosen when
+// the disk is created by "diskLatency" (-dl):
+//	TrackBufferLatency -- the disk described above
+//	ConstantLatency -- a device with no moving parts, such as flash:
+//		every request costs the same to start, wherever it is,
+//		and then so much per sector transferred
+//	ZonedLatency -- a disk whose outer tracks hold more sectors than
+//		its inner ones, so that it transfers faster, and seeks
+//		less, near the front of the disk
+// Other models can be added by deriving from DiskModel.
+//
+// The number of sectors per track, the number of tracks, and the
+// seek and rotation times, are variables, so that a disk of another
+// size or speed can be simulated (-dg, -dt).  The sector size is not:
+// the file system lays out its data structures to fit a sector.
+//
+// How the simulation gets at the UNIX file holding the disk does not
+// change the simulated time; it is chosen by "diskBackend" (-db):
+//	DiskFile -- seek and read or write the file for each request
+//	DiskMap -- map the whole file into memory, and copy sectors in
+//		and out of that; the file is brought up to date (msync)
+//		when the disk is deleted
+//	DiskMapSync -- the same, and also at every call to Sync, which
+//		SynchDisk makes a barrier (cf. SynchDisk::Flush)
 
 #define SectorSize 		128	// number of bytes per disk sector
-#define SectorsPerTrack 	32	// number of sectors per disk track 
-#define NumTracks 		32	// number of tracks per disk
+#define SectorsPerTrack 	sectorsPerTrack	// number of sectors per disk track 
+#define NumTracks 		numTracks	// number of tracks per disk
 #define NumSectors 		(SectorsPerTrack * NumTracks)
 					// total # of sectors per disk
+#define RotationTime 		rotationTime	// time disk takes to rotate one sector
+#define SeekTime 		seekTime	// time disk takes to seek past one track
+
+extern int sectorsPerTrack;		// geometry and timing of the disk,
+extern int numTracks;			//  set at startup (-dg, -dt); by
+extern int rotationTime;		//  default 32 tracks of 32 sectors,
+extern int seekTime;			//  500 ticks per sector and per track
+
+enum DiskBackend { DiskFile, DiskMap, DiskMapSync };
+
+extern DiskBackend diskBackend;		// backend for new Disks (-db)
+extern const char* diskBackendNames[];
+
+enum DiskLatency { TrackBufferLatency, ConstantLatency, ZonedLatency };
+
+extern DiskLatency diskLatency;		// latency model for new Disks (-dl)
+extern const char* diskLatencyNames[];
+
+// The following class defines how long a disk takes to carry out
+// a request.  Each Disk has one, and tells it about every request,
+// in order, as it is made; the model keeps track of where the head is.
+
+class DiskModel {
+  public:
+    virtual ~DiskModel() {}
+    virtual int Latency(int sectorNumber, int numSectors, bool writing) = 0;
+					// Return how long a request, made
+					// now, to read/write "numSectors"
+					// consecutive sectors starting at
+					// "sectorNumber" will take, and note
+					// where it leaves the head
+
+    static DiskModel *Create(DiskLatency kind);	// A new model of "kind"
+};
+
+// The disk with a track buffer, described above.
+
+class TrackBufferModel : public DiskModel {
+  public:
+    TrackBufferModel();
+    int Latency(int sectorNumber, int numSectors, bool writing);
+
+  private:
+    int lastSector;			// The previous disk request 
+    int bufferInit;			// When the track buffer started 
+					// being loaded
+
+    int ComputeLatency(int newSector, bool writing);	
+    					// Return how long a request to 
+					// newSector will take: 
+					// (seek + rotational delay + transfer)
+    int TimeToSeek(int newSector, int *rotate); // time to get to the new track
+    int ModuloDiff(int to, int from);        // # sectors between to and from
+    void UpdateLast(int newSector);
+    int RunLatency(int sectorNumber, int numSectors, int ticks);
+    					// extra time for the rest of a run
+};
+
+// A device that takes SeekTime to start any request, and RotationTime
+// for each sector it then transfers.
+
+class ConstantModel : public DiskModel {
+  public:
+    int Latency(int sectorNumber, int numSectors, bool writing);
+};
+
+// A disk split into NumZones zones, each holding an equal share of the
+// sectors.  A track in zone "z" holds SectorsPerTrack * (3 * NumZones/2 - z)
+// / NumZones sectors: from half again as many as a track of the nominal
+// geometry, in zone 0 at the outside of the disk, down to three
+// quarters as many, in the innermost zone.
+// The disk turns at the same speed throughout, once every
+// SectorsPerTrack * RotationTime ticks.  There is no track buffer.
+
+#define NumZones		4
+
+class ZonedModel : public DiskModel {
+  public:
+    ZonedModel();
+    int Latency(int sectorNumber, int numSectors, bool writing);
+
+  private:
+    int headTrack;			// Where the head was left
+
+    void Locate(int sector, int *track, int *offset, int *perTrack);
+					// Where "sector" is on the disk
+};
 
 class Disk {
   public:
@@ -66,28 +178,28 @@ class Disk {
     					// the disk and return immediately.
     					// Only one request allowed at a time!
     void WriteRequest(int sectorNumber, char* data);
+    void ReadRun(int sectorNumber, int numSectors, char* data);
+    void WriteRun(int sectorNumber, int numSectors, char* data);
+    					// Read/write "numSectors" consecutive
+					// sectors as a single request, with
+					// one interrupt when they are done.
 
     void HandleInterrupt();		// Interrupt handler, invoked when
 					// disk request finishes.
 
-    int ComputeLatency(int newSector, bool writing);	
-    					// Return how long a request to 
-					// newSector will take: 
-					// (seek + rotational delay + transfer)
+    void Sync();			// With DiskMapSync, wait until what
+					// was written so far is in the file
 
   private:
     int fileno;				// UNIX file number for simulated disk 
+    char *image;			// The file, mapped into memory; or
+					// NULL, to read and write it
+    bool syncOnBarrier;			// msync the file at each Sync?
     VoidFunctionPtr handler;		// Interrupt handler, to be invoked 
 					// when any disk request finishes
     _int handlerArg;			// Argument to interrupt handler 
     bool active;     			// Is a disk operation in progress?
-    int lastSector;			// The previous disk request 
-    int bufferInit;			// When the track buffer started 
-					// being loaded
-
-    int TimeToSeek(int newSector, int *rotate); // time to get to the new track
-    int ModuloDiff(int to, int from);        // # sectors between to and from
-    void UpdateLast(int newSector);
+    DiskModel *model;			// How long requests take
 };
 
 #endif // DISK_H
@@ -67,6 +67,8 @@ class PendingInterrupt {
     _int arg;           // The argument to the function.
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+    int serial;			// Order of scheduling, to break ties
+				// between interrupts due at the same time
 };
 
 // The following class defines the data structures for the simulation
@@ -114,8 +116,12 @@ class Interrupt {
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
-				// to occur in the future
+    PendingInterrupt **pending;	// the interrupts scheduled to occur in
+				// the future, as a binary heap: the next
+				// one due is always pending[0]
+    int numPending;		// how many of them there are
+    int maxPending;		// room in "pending"
+    int numScheduled;		// interrupts scheduled so far
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
@@ -125,6 +131,9 @@ class Interrupt {
 
     bool CheckIfDue(bool advanceClock); // Check if an interrupt is supposed
 					// to occur now
+    void InsertPending(PendingInterrupt *toOccur);
+    PendingInterrupt *RemovePending();	// Add to, or take the next one
+					// off, the heap of pending interrupts
 
     void ChangeLevel(IntStatus old, 	// SetLevel, without advancing the
 	IntStatus now);  		// simulated time
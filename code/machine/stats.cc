@@ -19,7 +19,10 @@
 Statistics::Statistics()
 {
     totalTicks = idleTicks = systemTicks = userTicks = 0;
-    numDiskReads = numDiskWrites = 0;
+    numDiskReads = numDiskWrites = numDiskSeeks = 0;
+    seekPolicy = NULL;
+    numCacheHits = numCacheMisses = 0;
+    numReadAheads = numReadAheadHits = numReadAheadWasted = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
 }
@@ -35,7 +38,14 @@ Statistics::Print()
 {
     printf("Ticks: total %d, idle %d, system %d, user %d\n", totalTicks, 
 	idleTicks, systemTicks, userTicks);
-    printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
+    printf("Disk I/O: reads %d, writes %d, seeks %d tracks", numDiskReads,
+	numDiskWrites, numDiskSeeks);
+    if (seekPolicy != NULL)
+	printf(" (%s)", seekPolicy);
+    printf("\n");
+    printf("Disk cache: hits %d, misses %d\n", numCacheHits, numCacheMisses);
+    printf("Read-ahead: sectors %d, hits %d, wasted %d\n", numReadAheads,
+	numReadAheadHits, numReadAheadWasted);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
     printf("Paging: faults %d\n", numPageFaults);
@@ -30,6 +30,16 @@ class Statistics {
 
     int numDiskReads;		// number of disk read requests
     int numDiskWrites;		// number of disk write requests
+    int numDiskSeeks;		// tracks the disk head has moved across,
+				// as the disk latency model (-dl) lays
+				// them out; none on "ssd"
+    const char *seekPolicy;	// disk scheduling policy (-ds) the seeks
+				// were made under, NULL if no SynchDisk
+    int numCacheHits;		// sector reads found in the disk cache
+    int numCacheMisses;		// sector reads that had to go to disk
+    int numReadAheads;		// sectors read ahead into the disk cache
+    int numReadAheadHits;	// ... and then read by someone
+    int numReadAheadWasted;	// ... and dropped from the cache unread
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
@@ -47,12 +57,11 @@ class Statistics {
 //
 // Since Nachos kernel code is directly executed, and the time spent
 // in the kernel measured by the number of calls to enable interrupts,
-// these time constants are none too exact.
+// these time constants are none too exact.  The disk's timing can be
+// set at startup, and so is kept with its geometry (cf. disk.h).
 
 #define UserTick 	1	// advance for each user-level instruction 
 #define SystemTick 	10 	// advance each time interrupts are enabled
-#define RotationTime 	500 	// time disk takes to rotate one sector
-#define SeekTime 	500    	// time disk takes to seek past one track
 #define ConsoleTime 	100	// time to read or write one character
 #define NetworkTime 	100   	// time to send or receive one packet
 #define TimerTicks 	100    	// (average) time between timer interrupts
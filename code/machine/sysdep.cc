@@ -251,6 +251,37 @@ void Close(int fd) {
 // bool
 int Unlink(char *name) { return (bool)unlink(name); }
 
+//----------------------------------------------------------------------
+// MapFile
+// 	Map the first "size" bytes of an open file into memory, so that
+//	storing into the memory changes the file.  Abort on error.
+//----------------------------------------------------------------------
+
+char *MapFile(int fd, int size) {
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    ASSERT(addr != MAP_FAILED);
+    return (char *)addr;
+}
+
+//----------------------------------------------------------------------
+// SyncMappedFile
+// 	Wait until the changes made to a file through its mapping are
+//	on disk.  Abort on error.
+//----------------------------------------------------------------------
+
+void SyncMappedFile(char *addr, int size) {
+    int retVal = msync(addr, size, MS_SYNC);
+    ASSERT(retVal >= 0);
+}
+
+//----------------------------------------------------------------------
+// UnmapFile
+// 	Undo MapFile.
+//----------------------------------------------------------------------
+
+void UnmapFile(char *addr, int size) { (void)munmap(addr, size); }
+
 //----------------------------------------------------------------------
 // OpenSocket
 // 	Open an interprocess communication (IPC) connection.  For now,
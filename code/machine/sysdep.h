@@ -30,6 +30,11 @@ extern void Close(int fd);
 // extern bool Unlink(char *name);
 extern int Unlink(char *name);
 
+// Mapping a file into memory: for simulating the disk
+extern char *MapFile(int fd, int size);
+extern void SyncMappedFile(char *addr, int size);
+extern void UnmapFile(char *addr, int size);
+
 // Interprocess communication operations, for simulating the network
 extern int OpenSocket();
 extern void CloseSocket(int sockID);
@@ -5,7 +5,9 @@
 // 	A "ListElement" is allocated for each item to be put on the
 //	list; it is de-allocated when the item is removed. This means
 //      we don't need to keep a "next" pointer in every object we
-//      want to put on a list.
+//      want to put on a list.  De-allocated elements are recycled,
+//	so only the first use of an element goes to the allocator.
+//	(Threads have their own, allocation-free, ThreadQueue.)
 // 
 //     	NOTE: Mutual exclusion must be provided by the caller.
 //  	If you want a synchronized list, you must use the routines 
@@ -18,6 +20,36 @@
 #include "copyright.h"
 #include "list.h"
 
+static ListElement *freeElements = NULL;	// recycled list elements
+
+//----------------------------------------------------------------------
+// ListElement::operator new, ListElement::operator delete
+// 	Allocate a list element from the free list of recycled ones,
+//	going to the allocator only if that is empty; and put a list
+//	element back on the free list when it is de-allocated.
+//----------------------------------------------------------------------
+
+void *
+ListElement::operator new(size_t size)
+{
+    ListElement *element = freeElements;
+
+    ASSERT(size == sizeof(ListElement));
+    if (element == NULL)
+	return ::operator new(size);
+    freeElements = element->next;
+    return element;
+}
+
+void
+ListElement::operator delete(void *ptr)
+{
+    ListElement *element = (ListElement *) ptr;
+
+    element->next = freeElements;
+    freeElements = element;
+}
+
 //----------------------------------------------------------------------
 // ListElement::ListElement
 // 	Initialize a list element, so it can be added somewhere on a list.
@@ -23,6 +23,10 @@
 //
 // Internal data structures kept public so that List operations can
 // access them directly.
+//
+// Elements that come off a list are kept on a free list, rather than
+// handed back to the allocator, so that a list in steady use (a
+// SynchList, say) does not allocate at all.
 
 class ListElement {
    public:
@@ -32,6 +36,9 @@ class ListElement {
 				// NULL if this is the last
      int key;		    	// priority, for a sorted list
      void *item; 	    	// pointer to item on the list
+
+     void *operator new(size_t size);	// take an element off the free list
+     void operator delete(void *ptr);	// put an element on the free list
 };
 
 // The following class defines a "list" -- a singly linked list of
@@ -11,8 +11,9 @@
 //	end up calling FindNextToRun(), and that would put us in an
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	Very simple implementation -- no priorities, straight FIFO --
+//	unless the multilevel feedback queue is selected with -mlfq
+//	(see scheduler.h).
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -28,19 +29,25 @@
 // 	Initialize the list of ready but not running threads to empty.
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler() { readyList = new List; }
+Scheduler::Scheduler() {
+    readyList = new ThreadQueue[NumLevels];
+    dispatchedAt = 0;
+    boostEpoch = 0;
+    nextBoost = BoostInterval;
+}
 
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
 // 	De-allocate the list of ready threads.
 //----------------------------------------------------------------------
 
-Scheduler::~Scheduler() { delete readyList; }
+Scheduler::~Scheduler() { delete[] readyList; }
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 // 	Mark a thread as ready, but not running.
-//	Put it on the ready list, for later scheduling onto the CPU.
+//	Put it on the ready list for its level, for later scheduling
+//	onto the CPU.
 //
 //	"thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
@@ -49,7 +56,8 @@ void Scheduler::ReadyToRun(Thread *thread) {
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
 
     thread->setStatus(READY);
-    readyList->Append((void *)thread);
+    Refresh(thread);
+    readyList[thread->level].Append(thread);
 }
 
 //----------------------------------------------------------------------
@@ -60,7 +68,93 @@ void Scheduler::ReadyToRun(Thread *thread) {
 //	Thread is removed from the ready list.
 //----------------------------------------------------------------------
 
-Thread *Scheduler::FindNextToRun() { return (Thread *)readyList->Remove(); }
+Thread *Scheduler::FindNextToRun() {
+    for (int i = 0; i < NumLevels; i++)
+        if (!readyList[i].IsEmpty()) return readyList[i].Remove();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SliceExpired
+// 	Called by the timer interrupt handler, to decide whether the
+//	current thread should be switched out.  Always, for round robin.
+//
+//	With -mlfq, only if a thread at a higher level is waiting (so
+//	that a thread woken up from I/O waits one timer tick at most),
+//	or if the current thread has used up its time slice, in which
+//	case it also drops a level.  Also boosts all threads back to
+//	level 0 when that is due.
+//----------------------------------------------------------------------
+
+bool Scheduler::SliceExpired() {
+    Thread *thread = currentThread;
+    int now = stats->totalTicks;
+
+    if (!mlfqScheduling) return TRUE;
+
+    if (now >= nextBoost) Boost();
+    Refresh(thread);
+
+    for (int i = 0; i < thread->level; i++)
+        if (!readyList[i].IsEmpty()) return TRUE;
+
+    if (thread->sliceUsed + now - dispatchedAt < (TimerTicks << thread->level))
+        return FALSE;
+
+    DEBUG('t', "Thread \"%s\" used up its slice at level %d\n",
+          thread->getName(), thread->level);
+    if (thread->level < NumLevels - 1) thread->level++;
+    thread->sliceUsed = 0;
+    dispatchedAt = now;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Charge
+// 	Charge the current thread, which is about to give up the CPU,
+//	for the time it has held it since it was dispatched.  Called by
+//	Thread::Yield and Thread::Sleep before they look for another
+//	thread, so that the time the CPU then spends idle, waiting for
+//	an interrupt to make a thread ready, is charged to no one.
+//----------------------------------------------------------------------
+
+void Scheduler::Charge() {
+    int now = stats->totalTicks;
+
+    currentThread->sliceUsed += now - dispatchedAt;
+    dispatchedAt = now;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Boost
+// 	Move every ready thread back to level 0, in order of level.
+//	Threads that are not on the ready list (the current thread,
+//	and those blocked) are only brought to level 0 by Refresh,
+//	the next time the scheduler looks at them.
+//----------------------------------------------------------------------
+
+void Scheduler::Boost() {
+    DEBUG('t', "Boosting all threads to level 0\n");
+
+    for (int i = 1; i < NumLevels; i++)
+        readyList[0].Concatenate(&readyList[i]);
+    boostEpoch++;
+    nextBoost = stats->totalTicks + BoostInterval;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Refresh
+// 	If there has been a priority boost since the scheduler last
+//	looked at "thread", move it back to level 0 with a fresh slice.
+//----------------------------------------------------------------------
+
+void Scheduler::Refresh(Thread *thread) {
+    if (thread->boostEpoch != boostEpoch) {
+        thread->boostEpoch = boostEpoch;
+        thread->level = 0;
+        thread->sliceUsed = 0;
+    }
+}
 
 //----------------------------------------------------------------------
 // Scheduler::Run
@@ -89,6 +183,9 @@ void Scheduler::Run(Thread *nextThread) {
     oldThread->CheckOverflow();  // check if the old thread
                                  // had an undetected stack overflow
 
+    dispatchedAt = stats->totalTicks;  // the old thread was charged by
+                                       // Charge, before any idling
+
     currentThread = nextThread;         // switch to the next thread
     currentThread->setStatus(RUNNING);  // nextThread is now running
 
@@ -128,5 +225,6 @@ void Scheduler::Run(Thread *nextThread) {
 //----------------------------------------------------------------------
 void Scheduler::Print() {
     printf("Ready list contents:\n");
-    readyList->Mapcar((VoidFunctionPtr)ThreadPrint);
+    for (int i = 0; i < NumLevels; i++)
+        readyList[i].Mapcar((VoidFunctionPtr)ThreadPrint);
 }
@@ -13,6 +13,18 @@
 #include "list.h"
 #include "thread.h"
 
+// With -mlfq, the scheduler is a multilevel feedback queue.  Threads
+// start at level 0, the highest.  The time slice at level i is
+// TimerTicks << i; a thread that uses up its slice at a level drops to
+// the next one, while one that blocks first keeps its level.  Every
+// BoostInterval ticks all threads go back to level 0, so that the
+// CPU-bound ones at the bottom do not starve.
+//
+// Without -mlfq, there is a single level, and every timer interrupt
+// switches to the next ready thread (round robin).
+#define NumLevels 4
+#define BoostInterval (50 * TimerTicks)
+
 // The following class defines the scheduler/dispatcher abstraction --
 // the data structures and operations needed to keep track of which
 // thread is running, and which threads are ready but not running.
@@ -28,9 +40,20 @@ class Scheduler {
     void Run(Thread* nextThread);     // Cause nextThread to start running
     void Print();                     // Print contents of ready list
 
+    bool SliceExpired();  // Called on a timer interrupt: should the
+                          // current thread give up the CPU?
+    void Charge();        // Charge the current thread for its time
+                          // on the CPU, before it gives it up
+
    private:
-    List* readyList;  // queue of threads that are ready to run,
-                      // but not running
+    ThreadQueue* readyList;  // queues of threads that are ready to run,
+                             // but not running, one per level
+    int dispatchedAt;  // when the current thread got the CPU
+    int boostEpoch;    // priority boosts so far
+    int nextBoost;     // when the next one is due
+
+    void Refresh(Thread* thread);  // Apply any boost the thread missed
+    void Boost();                  // Move all threads back to level 0
 };
 
 #endif  // SCHEDULER_H
@@ -11,6 +11,8 @@
 #include "system.h"
 #include "synch.h"
 
+#include <time.h>
+
 // See question 7.  The bridge can hold a maximum of 3 cars.  It is
 // one-lane, so cars may cross in one direction at a time only--otherwise
 // there is a head-on collision.
@@ -143,3 +145,50 @@ SynchTest()
 	ts[i]->Fork(SynchThread, i);
     }
 }
+
+//----------------------------------------------------------------------
+// PingPongTest
+//      Microbenchmark for blocking and waking up threads: two threads
+//      hand control back and forth "rounds" times through a pair of
+//      semaphores, so each round trip is two P's, two V's and two
+//      context switches.  Prints how long that took on the host.
+//----------------------------------------------------------------------
+
+static Semaphore *ping, *pong;
+static int pingPongRounds;
+
+static void
+PingPongThread(_int arg)
+{
+    for (int i = 0; i < pingPongRounds; i++) {
+	ping->P();
+	pong->V();
+    }
+}
+
+void
+PingPongTest(int rounds)
+{
+    Thread *t = new Thread("pong");
+    clock_t start;
+    double secs;
+
+    ping = new Semaphore("ping", 0);
+    pong = new Semaphore("pong", 0);
+    pingPongRounds = rounds;
+    t->Fork(PingPongThread, 0);
+
+    start = clock();
+    for (int i = 0; i < rounds; i++) {
+	ping->V();
+	pong->P();
+    }
+    secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Ping-pong: %d round trips in %.3f seconds", rounds, secs);
+    if (secs > 0)
+	printf(", %.0f per second", rounds / secs);
+    printf("\n");
+    delete ping;
+    delete pong;
+}
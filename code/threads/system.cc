@@ -18,6 +18,7 @@ Interrupt *interrupt;			// interrupt status
 Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
+bool mlfqScheduling = FALSE;		// multilevel feedback queue (-mlfq)
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -52,7 +53,8 @@ extern void Cleanup();
 //	which is what we wanted to context switch), we set a flag
 //	so that once the interrupt handler is done, it will appear as 
 //	if the interrupted thread called Yield at the point it is 
-//	was interrupted.
+//	was interrupted.  The scheduler decides whether to switch:
+//	round robin switches on every timer interrupt.
 //
 //	"dummy" is because every interrupt handler takes one argument,
 //		whether it needs it or not.
@@ -60,7 +62,7 @@ extern void Cleanup();
 static void
 TimerInterruptHandler(_int dummy)
 {
-    if (interrupt->getStatus() != IdleMode)
+    if (interrupt->getStatus() != IdleMode && scheduler->SliceExpired())
 	interrupt->YieldOnReturn();
 }
 
@@ -108,6 +110,12 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-mlfq")) {
+	    mlfqScheduling = TRUE;		// needs the timer
+	} else if (!strcmp(*argv, "-sp")) {
+	    ASSERT(argc > 1);
+	    stackPoolLimit = atoi(*(argv + 1));	// thread stacks kept
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
@@ -117,6 +125,68 @@ Initialize(int argc, char **argv)
 	if (!strcmp(*argv, "-f"))
 	    format = TRUE;
 #endif
+#ifdef FILESYS
+	if (!strcmp(*argv, "-ds")) {		// disk scheduling policy
+	    int i;
+
+	    ASSERT(argc > 1);
+	    for (i = FCFS; i < CLOOK; i++)
+		if (!strcmp(*(argv + 1), diskPolicyNames[i]))
+		    break;
+	    ASSERT(!strcmp(*(argv + 1), diskPolicyNames[i]));
+	    diskPolicy = (DiskPolicy) i;
+	    argCount = 2;
+	}
+	if (!strcmp(*argv, "-dc")) {		// disk cache size, in sectors
+	    ASSERT(argc > 1);
+	    diskCacheSize = atoi(*(argv + 1));
+	    ASSERT(diskCacheSize >= 0);
+	    argCount = 2;
+	}
+	if (!strcmp(*argv, "-ra")) {		// read-ahead window, in sectors
+	    ASSERT(argc > 1);
+	    readAheadWindow = atoi(*(argv + 1));
+	    ASSERT(readAheadWindow >= 0);
+	    argCount = 2;
+	}
+	if (!strcmp(*argv, "-db")) {		// how the disk file is accessed
+	    int i;
+
+	    ASSERT(argc > 1);
+	    for (i = DiskFile; i < DiskMapSync; i++)
+		if (!strcmp(*(argv + 1), diskBackendNames[i]))
+		    break;
+	    ASSERT(!strcmp(*(argv + 1), diskBackendNames[i]));
+	    diskBackend = (DiskBackend) i;
+	    argCount = 2;
+	}
+	if (!strcmp(*argv, "-dg")) {		// disk geometry: tracks, and
+	    ASSERT(argc > 2);			//  sectors per track
+	    numTracks = atoi(*(argv + 1));
+	    sectorsPerTrack = atoi(*(argv + 2));
+	    ASSERT(numTracks > 0 && sectorsPerTrack > 0);
+	    ASSERT(NumSectors % 32 == 0);	// whole words of the free map
+	    argCount = 3;
+	}
+	if (!strcmp(*argv, "-dt")) {		// disk timing, in ticks: per
+	    ASSERT(argc > 2);			//  track seeked, per sector
+	    seekTime = atoi(*(argv + 1));	//  rotated past
+	    rotationTime = atoi(*(argv + 2));
+	    ASSERT(seekTime >= 0 && rotationTime > 0);
+	    argCount = 3;
+	}
+	if (!strcmp(*argv, "-dl")) {		// disk latency model
+	    int i;
+
+	    ASSERT(argc > 1);
+	    for (i = TrackBufferLatency; i < ZonedLatency; i++)
+		if (!strcmp(*(argv + 1), diskLatencyNames[i]))
+		    break;
+	    ASSERT(!strcmp(*(argv + 1), diskLatencyNames[i]));
+	    diskLatency = (DiskLatency) i;
+	    argCount = 2;
+	}
+#endif
 #ifdef NETWORK
 	if (!strcmp(*argv, "-n")) {
 	    ASSERT(argc > 1);
@@ -138,7 +208,7 @@ Initialize(int argc, char **argv)
     stats = new Statistics();			// collect statistics
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new Scheduler();		// initialize the ready queue
-    if (randomYield)				// start the timer (if needed)
+    if (randomYield || mlfqScheduling)		// start the timer (if needed)
 	timer = new Timer(TimerInterruptHandler, 0, randomYield);
 
     threadToBeDestroyed = NULL;
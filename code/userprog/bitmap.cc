@@ -22,7 +22,9 @@ BitMap::BitMap(int nitems) {
     numBits = nitems;
     numWords = divRoundUp(numBits, BitsInWord);
     map = new unsigned int[numWords];
-    for (int i = 0; i < numBits; i++) Clear(i);
+    for (int i = 0; i < numWords; i++) map[i] = 0;
+    cursor = 0;
+    Recount();
 }
 
 //----------------------------------------------------------------------
@@ -41,7 +43,12 @@ BitMap::~BitMap() { delete map; }
 
 void BitMap::Mark(int which) {
     ASSERT(which >= 0 && which < numBits);
-    map[which / BitsInWord] |= 1 << (which % BitsInWord);
+    unsigned int bit = 1 << (which % BitsInWord);
+
+    if (!(map[which / BitsInWord] & bit)) {
+        map[which / BitsInWord] |= bit;
+        numClear--;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -53,7 +60,12 @@ void BitMap::Mark(int which) {
 
 void BitMap::Clear(int which) {
     ASSERT(which >= 0 && which < numBits);
-    map[which / BitsInWord] &= ~(1 << (which % BitsInWord));
+    unsigned int bit = 1 << (which % BitsInWord);
+
+    if (map[which / BitsInWord] & bit) {
+        map[which / BitsInWord] &= ~bit;
+        numClear++;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -72,9 +84,72 @@ bool BitMap::Test(int which) {
         return FALSE;
 }
 
+//----------------------------------------------------------------------
+// LowestBit
+// 	Return the number of the lowest set bit in a non-zero word.
+//----------------------------------------------------------------------
+
+static int LowestBit(unsigned int word) { return __builtin_ctz(word); }
+
+//----------------------------------------------------------------------
+// BitMap::NextClear
+// 	Return the number of the first clear bit in [from, to), or -1 if
+//	they are all set.  Whole words of set bits are skipped at once.
+//----------------------------------------------------------------------
+
+int BitMap::NextClear(int from, int to) {
+    int w = from / BitsInWord;
+    unsigned int bits;
+
+    if (from >= to) return -1;
+    bits = ~map[w] & (~0u << (from % BitsInWord));
+    while (bits == 0) {
+        if (++w * BitsInWord >= to) return -1;
+        bits = ~map[w];
+    }
+    from = w * BitsInWord + LowestBit(bits);
+    return (from < to) ? from : -1;
+}
+
+//----------------------------------------------------------------------
+// BitMap::NextSet
+// 	Return the number of the first set bit in [from, to), or "to" if
+//	they are all clear.
+//----------------------------------------------------------------------
+
+int BitMap::NextSet(int from, int to) {
+    int w = from / BitsInWord;
+    unsigned int bits;
+
+    if (from >= to) return to;
+    bits = map[w] & (~0u << (from % BitsInWord));
+    while (bits == 0) {
+        if (++w * BitsInWord >= to) return to;
+        bits = map[w];
+    }
+    from = w * BitsInWord + LowestBit(bits);
+    return (from < to) ? from : to;
+}
+
+//----------------------------------------------------------------------
+// BitMap::Recount
+// 	Count the clear bits after the whole map has been replaced.  The
+//	unused bits at the end of the last word are set, so that the word
+//	scans above never hand them out.
+//----------------------------------------------------------------------
+
+void BitMap::Recount() {
+    int extra = numWords * BitsInWord - numBits;
+
+    if (extra > 0) map[numWords - 1] |= ~0u << (BitsInWord - extra);
+    numClear = 0;
+    for (int i = 0; i < numWords; i++) numClear += __builtin_popcount(~map[i]);
+}
+
 //----------------------------------------------------------------------
 // BitMap::Find
-// 	Return the number of the first bit which is clear.
+// 	Return the number of a bit which is clear, searching from just
+//	after the bit found last time and wrapping around (next fit).
 //	As a side effect, set the bit (mark it as in use).
 //	(In other words, find and allocate a bit.)
 //
@@ -82,11 +157,45 @@ bool BitMap::Test(int which) {
 //----------------------------------------------------------------------
 
 int BitMap::Find() {
-    for (int i = 0; i < numBits; i++)
-        if (!Test(i)) {
-            Mark(i);
-            return i;
+    int which = NextClear(cursor, numBits);
+
+    if (which == -1) which = NextClear(0, cursor);
+    if (which == -1) return -1;
+    Mark(which);
+    cursor = (which + 1) % numBits;
+    return which;
+}
+
+//----------------------------------------------------------------------
+// BitMap::FindRun
+// 	Find "count" consecutive clear bits, taking the first such run
+//	at or after bit "from" and wrapping around, and set them all.
+//	Return the number of the first one, or -1 if there is no free
+//	run that long.  The next-fit cursor of Find is left alone, so
+//	the caller decides where runs go (e.g. near related data).
+//
+//	"count" is the length of the run wanted
+//	"from" is the bit to start searching at
+//----------------------------------------------------------------------
+
+int BitMap::FindRun(int count, int from) {
+    int at = from, to = numBits;
+    int start, end;
+
+    ASSERT(count > 0 && from >= 0 && from < numBits);
+    if (count > numClear) return -1;
+    for (int pass = 0; pass < 2; pass++) {  // [from, end), then [0, from)
+        while ((start = NextClear(at, to)) != -1) {
+            end = NextSet(start, numBits);
+            if (end - start >= count) {
+                for (int i = 0; i < count; i++) Mark(start + i);
+                return start;
+            }
+            at = end;
         }
+        at = 0;
+        to = from;
+    }
     return -1;
 }
 
@@ -96,13 +205,7 @@ int BitMap::Find() {
 //	(In other words, how many bits are unallocated?)
 //----------------------------------------------------------------------
 
-int BitMap::NumClear() {
-    int count = 0;
-
-    for (int i = 0; i < numBits; i++)
-        if (!Test(i)) count++;
-    return count;
-}
+int BitMap::NumClear() { return numClear; }
 
 //----------------------------------------------------------------------
 // BitMap::Print
@@ -130,6 +233,8 @@ void BitMap::Print() {
 
 void BitMap::FetchFrom(OpenFile *file) {
     file->ReadAt((char *)map, numWords * sizeof(unsigned), 0);
+    cursor = 0;
+    Recount();
 }
 
 //----------------------------------------------------------------------